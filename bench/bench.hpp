@@ -0,0 +1,89 @@
+/**
+ * @file bench.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 基准测试的注册和计时
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _BENCH_HPP_
+#define _BENCH_HPP_
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+namespace bench {
+using BenchFunc = void(*)();
+struct BenchCase{
+    const char* name;
+    BenchFunc func;
+};
+/**
+ * @brief 所有注册的基准测试，按注册顺序保存
+ *
+ * @return std::vector<BenchCase>&
+ */
+inline std::vector<BenchCase>& Registry(){
+    static std::vector<BenchCase> cases;
+    return cases;
+}
+struct Register{
+    Register(const char* name, BenchFunc func){
+        Registry().push_back(BenchCase{name, func});
+    }
+};
+/**
+ * @brief 阻止编译器把没有用到的结果优化掉
+ *
+ * @tparam T
+ * @param value
+ */
+template<typename T>
+inline void DoNotOptimize(const T& value){
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+inline uint64_t NowNs(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+/**
+ * @brief 先预热十分之一的次数，再计时执行iterations次op，打印每次的耗时和吞吐
+ *
+ * @tparam Func void()
+ * @param label 输出的名称
+ * @param iterations 计时的执行次数
+ * @param op 被测的操作
+ * @param bytes 每次操作处理的字节数，非0时同时打印带宽
+ * @return double 每次操作的纳秒数
+ */
+template<typename Func>
+double Run(const char* label, size_t iterations, Func&& op, size_t bytes = 0){
+    for(size_t i = 0; i < iterations / 10; i++){
+        op();
+    }
+    uint64_t start = NowNs();
+    for(size_t i = 0; i < iterations; i++){
+        op();
+    }
+    double ns = static_cast<double>(NowNs() - start) / iterations;
+    if(bytes > 0){
+        printf("  %-44s %10.1f ns/op %14.0f op/s %10.1f MB/s\n", label, ns, 1e9 / ns, bytes * 1e3 / ns);
+    }else{
+        printf("  %-44s %10.1f ns/op %14.0f op/s\n", label, ns, 1e9 / ns);
+    }
+    return ns;
+}
+}
+/**
+ * @brief 定义并注册一个基准测试，bench程序按名称选择运行
+ *
+ */
+#define BENCH(name) \
+    static void bench_##name(); \
+    static bench::Register bench_register_##name(#name, bench_##name); \
+    static void bench_##name()
+#endif
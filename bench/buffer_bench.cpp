@@ -0,0 +1,136 @@
+/**
+ * @file buffer_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief Buffer和ChainBuffer在流水线请求和响应下搬移的字节数
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../buffer/buffer.hpp"
+#include "../buffer/chain_buffer.hpp"
+#include <algorithm>
+#include <string>
+#include <sys/uio.h>
+namespace {
+constexpr size_t REQUESTS = 4096;
+constexpr size_t READ_BURST = 16384;//模拟一次readv读到的数据量
+constexpr size_t PIPELINE = 16;//一批写入的响应头个数
+/**
+ * @brief 固定种子的线性同余序列，保证每次运行的数据一样
+ *
+ */
+struct Lcg{
+    uint64_t state = 88172645463325252ull;
+    size_t Next(size_t lo, size_t hi){
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return lo + (state >> 33) % (hi - lo + 1);
+    }
+};
+struct Stream{
+    std::string data;
+    std::vector<size_t> sizes;
+};
+Stream MakeStream(size_t lo, size_t hi){
+    Stream stream;
+    Lcg lcg;
+    for(size_t i = 0; i < REQUESTS; i++){
+        size_t size = lcg.Next(lo, hi);
+        stream.sizes.push_back(size);
+        stream.data.append(size, static_cast<char>('a' + i % 26));
+    }
+    return stream;
+}
+/**
+ * @brief 追加数据，返回为腾出空间而搬移的未读字节数
+ *
+ */
+size_t AppendCounted(Buffer& buff, const char* data, size_t len){
+    const char* before = buff.Peek();
+    size_t readable = buff.ReadableBytes();
+    buff.Append(data, len);
+    return readable > 0 && buff.Peek() != before ? readable : 0;
+}
+size_t AppendCounted(ChainBuffer& buff, const char* data, size_t len){
+    buff.Append(data, len);//只写尾块和新块，已有数据不动
+    return 0;
+}
+/**
+ * @brief 取得一个请求的连续数据，返回为此合并的字节数。
+ * Buffer的可读数据总是连续的；ChainBuffer用Peek(len)只合并跨块的这个请求，
+ * 首块已读过的部分需要搬移时合并量按len计，否则按len减去首块已有的部分计
+ *
+ */
+size_t Contiguous(const Buffer& buff, size_t len){
+    bench::DoNotOptimize(buff.Peek()[len - 1]);
+    return 0;
+}
+size_t Contiguous(const ChainBuffer& buff, size_t len){
+    struct iovec head;
+    buff.GetReadIovec(&head, 1);
+    size_t copied = 0;
+    if(head.iov_len < len){
+        copied = buff.PrependableBytes() + len > SlabPool::CHUNK_DATA_SIZE ? len : len - head.iov_len;
+    }
+    bench::DoNotOptimize(buff.Peek(len)[len - 1]);
+    return copied;
+}
+/**
+ * @brief 读方向：按READ_BURST分批追加请求流，每批之后取出所有完整的请求
+ *
+ */
+template<typename BufferType>
+size_t ReadPass(BufferType& buff, const Stream& stream){
+    size_t copied = 0;
+    size_t req = 0;
+    for(size_t off = 0; off < stream.data.size(); off += READ_BURST){
+        size_t n = std::min(READ_BURST, stream.data.size() - off);
+        copied += AppendCounted(buff, stream.data.data() + off, n);
+        while(req < stream.sizes.size() && stream.sizes[req] <= buff.ReadableBytes()){
+            copied += Contiguous(buff, stream.sizes[req]);
+            buff.Retrieve(stream.sizes[req]);
+            req++;
+        }
+    }
+    return copied;
+}
+/**
+ * @brief 写方向：每次追加PIPELINE个响应头，然后模拟套接字只接收了一部分
+ *
+ */
+template<typename BufferType>
+size_t WritePass(BufferType& buff, const Stream& stream){
+    size_t copied = 0;
+    Lcg lcg;
+    const char* data = stream.data.data();
+    for(size_t req = 0; req < stream.sizes.size(); req += PIPELINE){
+        size_t end = std::min(req + PIPELINE, stream.sizes.size());
+        for(size_t i = req; i < end; i++){
+            copied += AppendCounted(buff, data, stream.sizes[i]);
+            data += stream.sizes[i];
+        }
+        buff.Retrieve(lcg.Next(1, buff.ReadableBytes()));
+    }
+    buff.RetrieveAll();
+    return copied;
+}
+template<typename BufferType>
+void Compare(const char* label, const Stream& stream, size_t (*pass)(BufferType&, const Stream&)){
+    BufferType buff;
+    size_t copied = pass(buff, stream);
+    char name[64];
+    snprintf(name, sizeof(name), "%s (%.1f B moved/req)", label, static_cast<double>(copied) / REQUESTS);
+    double ns = bench::Run(name, 200, [&]{ pass(buff, stream); }, stream.data.size());
+    printf("  %-44s %10.1f ns/req\n", "  per request", ns / REQUESTS);
+}
+}
+BENCH(buffer){
+    Stream requests = MakeStream(200, 800);//请求大小覆盖常见的浏览器请求
+    Compare<Buffer>("read Buffer", requests, ReadPass<Buffer>);
+    Compare<ChainBuffer>("read ChainBuffer", requests, ReadPass<ChainBuffer>);
+    Stream headers = MakeStream(120, 240);//响应头
+    Compare<Buffer>("write Buffer", headers, WritePass<Buffer>);
+    Compare<ChainBuffer>("write ChainBuffer", headers, WritePass<ChainBuffer>);
+}
@@ -0,0 +1,60 @@
+/**
+ * @file buffer_policy_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief Buffer和AtomicBuffer的Append/Retrieve吞吐
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../buffer/buffer.hpp"
+#include <cstring>
+namespace {
+constexpr size_t LINES = 64;//一批追加的行数，之后整批取走
+constexpr char LINE[] = "2026-10-17 12:00:00.000000 [info] : GET /index.html 200\n";
+constexpr size_t LINE_LEN = sizeof(LINE) - 1;
+/**
+ * @brief 日志缓冲的用法：逐行追加，整批写出后RetrieveAll
+ *
+ */
+template<typename BufferType>
+void AppendBatch(BufferType& buff){
+    for(size_t i = 0; i < LINES; i++){
+        buff.Append(LINE, LINE_LEN);
+    }
+    bench::DoNotOptimize(buff.Peek());
+    buff.RetrieveAll();
+}
+/**
+ * @brief 连接缓冲的用法：写入一段数据后按小段读取
+ *
+ */
+template<typename BufferType>
+void ReadSmall(BufferType& buff){
+    buff.EnsureWriteable(LINE_LEN * LINES);
+    memcpy(buff.BeginWrite(), LINE, LINE_LEN);//只关心读写位置的开销，其余内容不填
+    buff.HasWritten(LINE_LEN * LINES);
+    while(buff.ReadableBytes() >= 8){
+        bench::DoNotOptimize(*buff.Peek());
+        buff.Retrieve(8);
+    }
+    buff.RetrieveAll();
+}
+}
+BENCH(buffer_policy){
+    Buffer single;
+    AtomicBuffer atomic;
+    bench::Run("append Buffer", 100000, [&]{ AppendBatch(single); }, LINE_LEN * LINES);
+    bench::Run("append AtomicBuffer", 100000, [&]{ AppendBatch(atomic); }, LINE_LEN * LINES);
+    bench::Run("retrieve 8B Buffer", 100000, [&]{ ReadSmall(single); }, LINE_LEN * LINES);
+    bench::Run("retrieve 8B AtomicBuffer", 100000, [&]{ ReadSmall(atomic); }, LINE_LEN * LINES);
+    //RetrieveAll只重置读写位置，和缓冲已经增长到多大无关
+    Buffer large(1 << 24);
+    bench::Run("Append+RetrieveAll on 16MB Buffer", 1000000, [&]{
+        large.Append(LINE, LINE_LEN);
+        large.RetrieveAll();
+        bench::DoNotOptimize(large.ReadableBytes());
+    });
+}
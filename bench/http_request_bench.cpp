@@ -0,0 +1,35 @@
+/**
+ * @file http_request_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 请求解析的单核吞吐，浏览器请求和wrk请求
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "http_samples.hpp"
+#include "../http/http_request.hpp"
+#include <cstring>
+namespace {
+/**
+ * @brief 每次从头解析一个完整的请求
+ *
+ */
+void ParseSample(const char* name, const char* sample){
+    const size_t len = strlen(sample);
+    HttpRequest request;
+    char label[64];
+    snprintf(label, sizeof(label), "%s %zuB", name, len);
+    bench::Run(label, 2000000, [&]{
+        request.Init();
+        request.Parse(sample, len);
+        bench::DoNotOptimize(request.Length());
+    }, len);
+}
+}
+BENCH(http_request){
+    ParseSample("browser", bench::BROWSER_REQUEST);
+    ParseSample("wrk", bench::WRK_REQUEST);
+}
@@ -0,0 +1,51 @@
+/**
+ * @file http_response_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 生成普通200响应头的耗时，和snprintf加strftime的写法对比
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../http/http_response.hpp"
+#include <ctime>
+namespace {
+constexpr size_t ITERATIONS = 2000000;
+/**
+ * @brief 每次生成一个响应头再取走，长度随Content-Length变化
+ *
+ */
+template<typename BufferType>
+void RenderInto(const char* label, BufferType& buff){
+    uint64_t length = 1024;
+    bench::Run(label, ITERATIONS, [&]{
+        BasicHttpResponse<BufferType>(buff).Head(200, true).ContentLength(length++).ContentType("/index.html").End();
+        bench::DoNotOptimize(buff.ReadableBytes());
+        buff.RetrieveAll();
+    });
+}
+}
+BENCH(http_response){
+    Buffer buff(4096);
+    RenderInto("HttpResponse -> Buffer", buff);
+    ChainBuffer chain;
+    RenderInto("HttpResponse -> ChainBuffer", chain);
+    //每次都格式化日期，和逐个连接拼接响应头的常见写法相同
+    uint64_t length = 1024;
+    bench::Run("snprintf + strftime -> Buffer", ITERATIONS, [&]{
+        char date[64];
+        time_t now = time(nullptr);
+        struct tm tm;
+        gmtime_r(&now, &tm);
+        strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        char out[512];
+        int n = snprintf(out, sizeof(out), "HTTP/1.1 %d %s\r\nServer: webserver\r\nDate: %s\r\nConnection: %s\r\n"
+                         "Content-Length: %llu\r\nContent-Type: %s\r\n\r\n", 200, "OK", date, "keep-alive",
+                         static_cast<unsigned long long>(length++), "text/html; charset=utf-8");
+        buff.Append(out, n);
+        bench::DoNotOptimize(buff.ReadableBytes());
+        buff.RetrieveAll();
+    });
+}
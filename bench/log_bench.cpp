@@ -0,0 +1,47 @@
+/**
+ * @file log_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 异步文本日志在1到32个写日志线程下的吞吐
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../log/log.hpp"
+#include <cstdlib>
+#include <thread>
+#include <vector>
+namespace {
+constexpr int TOTAL_LINES = 400000;//每种线程数下写的总行数
+}
+BENCH(log){
+    char dir[] = "/tmp/webserver_bench_log_XXXXXX";//日志写到临时目录，测试完不删除，方便查看
+    if(!mkdtemp(dir)){
+        perror("mkdtemp");
+        return;
+    }
+    Log::Instance()->init(INFO, dir, ".log", 1024);
+    printf("  writing to %s\n", dir);
+    printf("  %-8s %14s %14s\n", "threads", "lines/s", "ns/line");
+    for(int threads = 1; threads <= 32; threads *= 2){
+        const int perThread = TOTAL_LINES / threads;
+        std::vector<std::thread> producers;
+        uint64_t start = bench::NowNs();
+        for(int t = 0; t < threads; t++){
+            producers.emplace_back([t, perThread]{
+                for(int i = 0; i < perThread; i++){
+                    LOG_INFO("client[%d] line %d GET /index.html 200 %s", t, i, "keep-alive");
+                }
+            });
+        }
+        for(std::thread& producer : producers){
+            producer.join();
+        }
+        double ns = static_cast<double>(bench::NowNs() - start);
+        const double lines = static_cast<double>(perThread) * threads;
+        printf("  %-8d %14.0f %14.1f\n", threads, lines * 1e9 / ns, ns / lines);
+    }
+    Log::Instance()->flush();
+}
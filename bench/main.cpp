@@ -0,0 +1,38 @@
+/**
+ * @file main.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 基准测试入口，不带参数时运行全部，否则只运行指定名称的测试
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include <cstring>
+int main(int argc, char* argv[]){
+    if(argc > 1 && strcmp(argv[1], "-l") == 0){
+        for(const bench::BenchCase& c : bench::Registry()){
+            printf("%s\n", c.name);
+        }
+        return 0;
+    }
+    int ran = 0;
+    for(const bench::BenchCase& c : bench::Registry()){
+        bool selected = argc == 1;
+        for(int i = 1; i < argc && !selected; i++){
+            selected = strcmp(argv[i], c.name) == 0;
+        }
+        if(!selected){
+            continue;
+        }
+        printf("[%s]\n", c.name);
+        c.func();
+        ran++;
+    }
+    if(ran == 0){
+        fprintf(stderr, "no benchmark matched, use -l to list\n");
+        return 1;
+    }
+    return 0;
+}
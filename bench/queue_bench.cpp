@@ -0,0 +1,78 @@
+/**
+ * @file queue_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief RingQueue和BlockQueue在不同生产者、消费者个数下的吞吐
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../log/blockQueue.hpp"
+#include "../log/ring_queue.hpp"
+#include <thread>
+#include <vector>
+namespace {
+constexpr int TOTAL_ITEMS = 400000;//每种组合传递的总元素数
+constexpr size_t CAPACITY = 1024;
+constexpr int STOP = -1;//生产者都结束后每个消费者收到一个，收到后退出
+/**
+ * @brief 生产者用push_back放入，消费者用阻塞的pop取出
+ *
+ * @tparam Queue
+ * @return double 每个元素的纳秒数
+ */
+template<typename Queue>
+double Transfer(int producers, int consumers){
+    Queue queue(CAPACITY);
+    const int perProducer = TOTAL_ITEMS / producers;
+    std::vector<std::thread> threads;
+    std::vector<long long> sums(consumers, 0);
+    uint64_t start = bench::NowNs();
+    for(int c = 0; c < consumers; c++){
+        threads.emplace_back([&queue, &sums, c]{
+            int value;
+            while(queue.pop(value) && value != STOP){
+                sums[c] += value;
+            }
+        });
+    }
+    for(int p = 0; p < producers; p++){
+        threads.emplace_back([&queue, perProducer]{
+            for(int i = 0; i < perProducer; i++){
+                queue.push_back(i);
+            }
+        });
+    }
+    for(size_t t = consumers; t < threads.size(); t++){
+        threads[t].join();
+    }
+    for(int c = 0; c < consumers; c++){
+        queue.push_back(STOP);
+    }
+    for(int c = 0; c < consumers; c++){
+        threads[c].join();
+    }
+    double ns = static_cast<double>(bench::NowNs() - start);
+    long long total = 0;
+    for(long long sum : sums){
+        total += sum;
+    }
+    if(total != static_cast<long long>(perProducer - 1) * perProducer / 2 * producers){
+        fprintf(stderr, "queue lost items\n");
+    }
+    return ns / (static_cast<double>(perProducer) * producers);
+}
+}
+BENCH(queue){
+    static const int combos[][2] = {{1, 1}, {1, 4}, {4, 1}, {2, 2}, {4, 4}, {8, 8}};
+    printf("  %-12s %14s %14s %14s %14s\n", "P/C", "ring ns/item", "ring item/s", "block ns/item", "block item/s");
+    for(const auto& combo : combos){
+        double ring = Transfer<RingQueue<int>>(combo[0], combo[1]);
+        double block = Transfer<BlockQueue<int>>(combo[0], combo[1]);
+        char label[16];
+        snprintf(label, sizeof(label), "%d/%d", combo[0], combo[1]);
+        printf("  %-12s %14.1f %14.0f %14.1f %14.0f\n", label, ring, 1e9 / ring, block, 1e9 / block);
+    }
+}
@@ -0,0 +1,196 @@
+/**
+ * @file reactor_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 事件循环个数从1到4时的请求吞吐和新建连接吞吐
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../main/reactor.hpp"
+#include <arpa/inet.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+namespace {
+constexpr int PORT = 23916;
+constexpr int CLIENTS = 8;//客户端线程数，每个线程一个连接
+constexpr int RUN_MS = 2000;//每种配置的运行时间
+const char REQUEST[] = "GET / HTTP/1.1\r\nHost: bench\r\n\r\n";
+const char RESPONSE[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+/**
+ * @brief 每个以空行结束的请求回复一个固定的响应，只测事件循环本身的开销
+ *
+ */
+class FixedConnection : public Connection{
+    public:
+        FixedConnection(Reactor* loop, int fd, const sockaddr_in& addr, bool keepAlive)
+            :Connection(loop, fd, addr),keepAlive_(keepAlive){}
+        bool OnRead(bool edge) override{
+            char buff[4096];
+            do{
+                ssize_t n = read(fd_, buff, sizeof(buff));
+                if(n == 0){
+                    return false;
+                }
+                if(n < 0){
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                for(ssize_t i = 0; i < n; i++){//请求可能跨两次读，记住已经匹配的空行前缀
+                    matched_ = buff[i] == "\r\n\r\n"[matched_] ? matched_ + 1 : (buff[i] == '\r' ? 1 : 0);
+                    if(matched_ == 4){
+                        out_.append(RESPONSE, sizeof(RESPONSE) - 1);
+                        matched_ = 0;
+                    }
+                }
+            }while(edge);
+            return true;
+        }
+        bool OnWrite() override{
+            while(sent_ < out_.size()){
+                ssize_t n = write(fd_, out_.data() + sent_, out_.size() - sent_);
+                if(n < 0){
+                    return errno == EAGAIN || errno == EWOULDBLOCK;
+                }
+                sent_ += n;
+            }
+            out_.clear();
+            sent_ = 0;
+            return true;
+        }
+        bool WantWrite() const override{
+            return sent_ < out_.size();
+        }
+        bool KeepAlive() const override{
+            return keepAlive_;
+        }
+    private:
+        bool keepAlive_;
+        size_t matched_ = 0;
+        std::string out_;
+        size_t sent_ = 0;
+};
+int Connect(){
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(PORT);
+    if(connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+/**
+ * @brief 发送一个请求并读完一个响应
+ *
+ * @return false 连接出错
+ */
+bool RoundTrip(int fd){
+    if(write(fd, REQUEST, sizeof(REQUEST) - 1) != static_cast<ssize_t>(sizeof(REQUEST) - 1)){
+        return false;
+    }
+    char buff[256];
+    size_t got = 0;
+    while(got < sizeof(RESPONSE) - 1){
+        ssize_t n = read(fd, buff, sizeof(buff));
+        if(n <= 0){
+            return false;
+        }
+        got += n;
+    }
+    return true;
+}
+/**
+ * @brief 启动loops个事件循环，CLIENTS个线程在RUN_MS毫秒里重复执行client
+ *
+ * @return double 每秒完成的次数
+ */
+template<typename Client>
+double Measure(int loops, bool keepAlive, Client client){
+    ReactorOptions options;
+    options.port = PORT;
+    options.timeout_ms = 0;
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    for(int i = 0; i < loops; i++){
+        reactors.emplace_back(new Reactor(options, [keepAlive](Reactor* loop, int fd, const sockaddr_in& addr){
+            return std::unique_ptr<Connection>(new FixedConnection(loop, fd, addr, keepAlive));
+        }, nullptr));
+        if(!reactors.back()->Listen()){
+            fprintf(stderr, "listen on %d failed\n", PORT);
+            return 0;
+        }
+    }
+    std::vector<std::thread> threads;
+    for(auto& reactor : reactors){
+        threads.emplace_back([&reactor]{ reactor->Loop(); });
+    }
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> done(0);
+    uint64_t start = bench::NowNs();
+    std::vector<std::thread> clients;
+    for(int c = 0; c < CLIENTS; c++){
+        clients.emplace_back([&]{
+            uint64_t n = client(stop);
+            done.fetch_add(n, std::memory_order_relaxed);
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(RUN_MS));
+    stop.store(true);
+    for(std::thread& thread : clients){
+        thread.join();
+    }
+    double ns = static_cast<double>(bench::NowNs() - start);
+    for(auto& reactor : reactors){
+        reactor->Stop();
+    }
+    for(std::thread& thread : threads){
+        thread.join();
+    }
+    return done.load() * 1e9 / ns;
+}
+}
+BENCH(reactor){
+    //keep-alive连接上一问一答
+    auto requests = [](std::atomic<bool>& stop){
+        uint64_t n = 0;
+        int fd = Connect();
+        while(fd >= 0 && !stop.load(std::memory_order_relaxed) && RoundTrip(fd)){
+            n++;
+        }
+        if(fd >= 0){
+            close(fd);
+        }
+        return n;
+    };
+    //每个请求新建连接，响应后服务器关闭
+    auto connections = [](std::atomic<bool>& stop){
+        uint64_t n = 0;
+        while(!stop.load(std::memory_order_relaxed)){
+            int fd = Connect();
+            if(fd < 0){
+                break;
+            }
+            n += RoundTrip(fd);
+            close(fd);
+        }
+        return n;
+    };
+    printf("  %u cpu(s), %d client threads\n", std::thread::hardware_concurrency(), CLIENTS);
+    printf("  %-8s %14s %14s\n", "loops", "req/s", "conn/s");
+    for(int loops = 1; loops <= 4; loops *= 2){
+        double req = Measure(loops, true, requests);
+        double conn = Measure(loops, false, connections);
+        printf("  %-8d %14.0f %14.0f\n", loops, req, conn);
+    }
+}
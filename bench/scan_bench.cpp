@@ -0,0 +1,143 @@
+/**
+ * @file scan_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 向量化查找和std::search、memchr等逐字节循环在真实请求头上的对比
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "http_samples.hpp"
+#include "../buffer/scan.hpp"
+#include <algorithm>
+#include <cstring>
+namespace {
+constexpr size_t ITERATIONS = 200000;
+const char* const ISA_NAMES[] = {"scalar", "sse4.2", "avx2"};
+const char* const BLOCK = bench::BROWSER_REQUEST;
+const char* const BLOCK_END = BLOCK + sizeof(bench::BROWSER_REQUEST) - 1;
+const size_t BLOCK_LEN = sizeof(bench::BROWSER_REQUEST) - 1;
+/**
+ * @brief RFC 9110的token字符，逐字节查表的对照实现
+ *
+ */
+bool IsTokenChar(unsigned char c){
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || (c && strchr("!#$%&'*+-.^_`|~", c));
+}
+/**
+ * @brief 对请求头的每一行(不含\r\n)调用f，返回f结果的和
+ *
+ */
+template<typename Func>
+size_t ForEachLine(Func&& f){
+    size_t sum = 0;
+    const char* p = BLOCK;
+    const char* lf;
+    while((lf = static_cast<const char*>(memchr(p, '\n', BLOCK_END - p)))){
+        sum += f(p, lf - 1);
+        p = lf + 1;
+    }
+    return sum;
+}
+/**
+ * @brief 依次用每种指令集运行同一个测试，CPU不支持的级别跳过
+ *
+ */
+template<typename Func>
+void RunIsas(const char* what, Func&& op){
+    for(int isa = SCAN_SCALAR; isa <= SCAN_AVX2; isa++){
+        if(SetScanIsa(static_cast<SCAN_ISA>(isa)) != isa){
+            continue;
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%s %s", what, ISA_NAMES[isa]);
+        bench::Run(label, ITERATIONS, [&]{ bench::DoNotOptimize(op()); }, BLOCK_LEN);
+    }
+    SetScanIsa(SCAN_AVX2);
+}
+}
+BENCH(scan){
+    //找出所有行尾
+    bench::Run("lines std::search", ITERATIONS, [&]{
+        static const char crlf[] = "\r\n";
+        size_t count = 0;
+        const char* p = BLOCK;
+        while((p = std::search(p, BLOCK_END, crlf, crlf + 2)) != BLOCK_END){
+            count++;
+            p += 2;
+        }
+        bench::DoNotOptimize(count);
+    }, BLOCK_LEN);
+    bench::Run("lines memchr", ITERATIONS, [&]{
+        size_t count = 0;
+        const char* p = BLOCK;
+        while((p = static_cast<const char*>(memchr(p, '\n', BLOCK_END - p)))){
+            count += p > BLOCK && p[-1] == '\r';
+            p++;
+        }
+        bench::DoNotOptimize(count);
+    }, BLOCK_LEN);
+    bench::Run("lines FindCRLF", ITERATIONS, [&]{//不按指令集分派
+        size_t count = 0;
+        const char* p = BLOCK;
+        while((p = FindCRLF(p, BLOCK_END))){
+            count++;
+            p += 2;
+        }
+        bench::DoNotOptimize(count);
+    }, BLOCK_LEN);
+    //校验每行开头的头部名并找到后面的冒号
+    bench::Run("names byte loop", ITERATIONS, [&]{
+        bench::DoNotOptimize(ForEachLine([](const char* begin, const char* end){
+            const char* p = begin;
+            while(p < end && IsTokenChar(*p)){
+                p++;
+            }
+            return static_cast<size_t>(p - begin);
+        }));
+    }, BLOCK_LEN);
+    RunIsas("names FindNonToken", []{
+        return ForEachLine([](const char* begin, const char* end){
+            const char* p = FindNonToken(begin, end);
+            return static_cast<size_t>((p ? p : end) - begin);
+        });
+    });
+    //头部值里的控制字符
+    bench::Run("values byte loop", ITERATIONS, [&]{
+        bench::DoNotOptimize(ForEachLine([](const char* begin, const char* end){
+            const char* p = begin;
+            while(p < end && !((static_cast<unsigned char>(*p) < 0x20 && *p != '\t') || *p == 0x7f)){
+                p++;
+            }
+            return static_cast<size_t>(p - begin);
+        }));
+    }, BLOCK_LEN);
+    RunIsas("values FindCtl", []{
+        return ForEachLine([](const char* begin, const char* end){
+            const char* p = FindCtl(begin, end, true);
+            return static_cast<size_t>((p ? p : end) - begin);
+        });
+    });
+    //查找一组分隔符
+    bench::Run("any(;,) std::find_first_of", ITERATIONS, [&]{
+        static const char set[] = ";,";
+        size_t count = 0;
+        const char* p = BLOCK;
+        while((p = std::find_first_of(p, BLOCK_END, set, set + 2)) != BLOCK_END){
+            count++;
+            p++;
+        }
+        bench::DoNotOptimize(count);
+    }, BLOCK_LEN);
+    RunIsas("any(;,) FindAny", []{
+        size_t count = 0;
+        const char* p = BLOCK;
+        while((p = FindAny(p, BLOCK_END, ";,", 2))){
+            count++;
+            p++;
+        }
+        return count;
+    });
+}
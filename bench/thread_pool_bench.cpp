@@ -0,0 +1,150 @@
+/**
+ * @file thread_pool_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 工作窃取线程池和单锁队列线程池的任务吞吐与提交到开始执行的延迟
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../pool/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+namespace {
+constexpr size_t THROUGHPUT_TASKS = 200000;
+constexpr size_t LATENCY_TASKS = 2000;
+constexpr size_t BATCH = 64;//SubmitBatch每批的任务数
+constexpr uint64_t LATENCY_GAP_NS = 20000;//延迟测试中两次提交的间隔，让工作线程先进入休眠
+/**
+ * @brief 改写前的线程池：一把锁、一个条件变量和一个std::function队列，作为对比的基线
+ *
+ */
+class MutexPool{
+    public:
+        explicit MutexPool(size_t thread_count){
+            for(size_t i = 0; i < thread_count; i++){
+                threads_.emplace_back([this]{
+                    std::unique_lock<std::mutex> locker(mtx_);
+                    while(true){
+                        if(!tasks_.empty()){
+                            std::function<void()> task = std::move(tasks_.front());
+                            tasks_.pop();
+                            locker.unlock();
+                            task();
+                            locker.lock();
+                        }else if(closed_){
+                            break;
+                        }else{
+                            cond_.wait(locker);
+                        }
+                    }
+                });
+            }
+        }
+        ~MutexPool(){
+            {
+                std::lock_guard<std::mutex> locker(mtx_);
+                closed_ = true;
+            }
+            cond_.notify_all();
+            for(std::thread& t : threads_){
+                t.join();
+            }
+        }
+        template<typename T>
+        void AddTasK(T &&task){
+            {
+                std::lock_guard<std::mutex> locker(mtx_);
+                tasks_.emplace(std::forward<T>(task));
+            }
+            cond_.notify_one();
+        }
+    private:
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        bool closed_ = false;
+        std::queue<std::function<void()>> tasks_;
+        std::vector<std::thread> threads_;
+};
+void WaitFor(const std::atomic<size_t>& counter, size_t target){
+    while(counter.load(std::memory_order_acquire) < target){
+        std::this_thread::yield();
+    }
+}
+/**
+ * @brief 外部线程连续提交空任务，直到全部执行完的吞吐
+ *
+ */
+template<typename Pool>
+double Throughput(size_t threads){
+    Pool pool(threads);
+    std::atomic<size_t> done{0};
+    uint64_t start = bench::NowNs();
+    for(size_t i = 0; i < THROUGHPUT_TASKS; i++){
+        pool.AddTasK([&done]{ done.fetch_add(1, std::memory_order_release); });
+    }
+    WaitFor(done, THROUGHPUT_TASKS);
+    return THROUGHPUT_TASKS * 1e9 / (bench::NowNs() - start);
+}
+/**
+ * @brief 用SubmitBatch每批提交BATCH个任务的吞吐，每批只唤醒一次
+ *
+ */
+double BatchThroughput(size_t threads){
+    ThreadPool pool(threads);
+    std::atomic<size_t> done{0};
+    std::vector<std::function<void()>> batch;
+    uint64_t start = bench::NowNs();
+    for(size_t i = 0; i < THROUGHPUT_TASKS; i += BATCH){
+        batch.assign(BATCH, [&done]{ done.fetch_add(1, std::memory_order_release); });
+        pool.SubmitBatch(batch);
+    }
+    WaitFor(done, THROUGHPUT_TASKS);
+    return THROUGHPUT_TASKS * 1e9 / (bench::NowNs() - start);
+}
+/**
+ * @brief 间隔提交任务，统计提交到开始执行的延迟，返回p50和p99
+ *
+ */
+template<typename Pool>
+std::pair<uint64_t, uint64_t> Latency(size_t threads){
+    Pool pool(threads);
+    std::vector<uint64_t> latency(LATENCY_TASKS);
+    std::atomic<size_t> done{0};
+    for(size_t i = 0; i < LATENCY_TASKS; i++){
+        uint64_t submit = bench::NowNs();
+        pool.AddTasK([&latency, &done, i, submit]{
+            latency[i] = bench::NowNs() - submit;
+            done.fetch_add(1, std::memory_order_release);
+        });
+        while(bench::NowNs() - submit < LATENCY_GAP_NS){
+            std::this_thread::yield();
+        }
+    }
+    WaitFor(done, LATENCY_TASKS);
+    std::sort(latency.begin(), latency.end());
+    return {latency[LATENCY_TASKS / 2], latency[LATENCY_TASKS * 99 / 100]};
+}
+}
+BENCH(thread_pool){
+    printf("  %-8s %14s %14s %14s %18s %18s\n", "workers", "mutex task/s", "steal task/s", "batch task/s",
+        "mutex p50/p99 ns", "steal p50/p99 ns");
+    for(size_t threads = 1; threads <= 64; threads *= 2){
+        double mutexRate = Throughput<MutexPool>(threads);
+        double stealRate = Throughput<ThreadPool>(threads);
+        double batchRate = BatchThroughput(threads);
+        std::pair<uint64_t, uint64_t> mutexLatency = Latency<MutexPool>(threads);
+        std::pair<uint64_t, uint64_t> stealLatency = Latency<ThreadPool>(threads);
+        printf("  %-8zu %14.0f %14.0f %14.0f %8lu/%-9lu %8lu/%-9lu\n", threads, mutexRate, stealRate, batchRate,
+            static_cast<unsigned long>(mutexLatency.first), static_cast<unsigned long>(mutexLatency.second),
+            static_cast<unsigned long>(stealLatency.first), static_cast<unsigned long>(stealLatency.second));
+    }
+}
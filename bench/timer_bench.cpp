@@ -0,0 +1,98 @@
+/**
+ * @file timer_bench.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 时间轮和小根堆定时器在大量连接下的添加、刷新、删除和超时开销
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "bench.hpp"
+#include "../timer/heap_timer.hpp"
+#include "../timer/timing_wheel.hpp"
+#include <vector>
+namespace {
+constexpr int CONNS = 10000;//同时存在的定时器数
+constexpr int TIMEOUT_MS = 60000;
+/**
+ * @brief 每个连接的超时不同，避免所有节点落在同一个槽或者堆的同一层
+ *
+ */
+std::vector<int> MakeTimeouts(){
+    std::vector<int> timeouts(CONNS);
+    uint32_t x = 2463534242u;
+    for(int& t : timeouts){
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        t = TIMEOUT_MS / 2 + static_cast<int>(x % TIMEOUT_MS);
+    }
+    return timeouts;
+}
+}
+BENCH(timer){
+    const std::vector<int> timeouts = MakeTimeouts();
+    size_t fired = 0;
+    auto count = [&fired](int){ fired++; };
+    {
+        TimingWheel wheel(1);
+        wheel.SetExpireCallBack(count);
+        bench::Run("wheel add+cancel 10k", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                wheel.add(id, timeouts[id]);
+            }
+            for(int id = 0; id < CONNS; id++){
+                wheel.cancel(id);
+            }
+        });
+        for(int id = 0; id < CONNS; id++){
+            wheel.add(id, timeouts[id]);
+        }
+        //连接每次有读写就把超时推后，事件循环每轮再处理一次超时
+        bench::Run("wheel adjust 10k + GetNextTick", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                wheel.adjust(id, timeouts[id]);
+            }
+            bench::DoNotOptimize(wheel.GetNextTick());
+        });
+        wheel.clear();
+        int64_t now = wheel.NowMs();
+        bench::Run("wheel add 10k + expire all", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                wheel.add(id, id % 256);
+            }
+            now += 256;
+            wheel.tick(now);
+        });
+    }
+    {
+        HeapTimer heap;
+        auto call_back = [&fired]{ fired++; };
+        bench::Run("heap add+cancel 10k", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                heap.add(id, timeouts[id], call_back);
+            }
+            for(int id = 0; id < CONNS; id++){
+                heap.cancel(id);
+            }
+        });
+        for(int id = 0; id < CONNS; id++){
+            heap.add(id, timeouts[id], call_back);
+        }
+        bench::Run("heap adjust 10k + GetNextTick", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                heap.adjust(id, timeouts[id]);
+            }
+            bench::DoNotOptimize(heap.GetNextTick());
+        });
+        heap.clear();
+        bench::Run("heap add 10k + expire all", 200, [&]{
+            for(int id = 0; id < CONNS; id++){
+                heap.add(id, 0, call_back);
+            }
+            heap.tick();
+        });
+    }
+    bench::DoNotOptimize(fired);
+}
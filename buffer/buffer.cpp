@@ -9,6 +9,7 @@
  * 
  */
 #include "buffer.hpp"
+#include "scan.hpp"
 #include <cassert>
 #include <cstddef>
 #include <sys/types.h>
@@ -16,108 +17,185 @@
 #include <cstring>
 #include "sys/uio.h"
 #include <iostream>
-Buffer::Buffer(size_t initBufferSize):buffer_(initBufferSize),read_pos_(0),write_pos_(0){
+#include <algorithm>
+namespace {
+thread_local char read_scratch[65536];//同一线程所有缓冲共享的溢出临时缓冲
+thread_local BufferReadStats thread_read_stats;//当前线程的读取统计
+}
+template<typename PosPolicy>
+BasicBuffer<PosPolicy>::BasicBuffer(size_t initBufferSize):buffer_(initBufferSize),read_pos_(0),write_pos_(0),
+    init_size_(initBufferSize),
+    read_hint_(std::min(std::max(initBufferSize,MIN_READ_HINT),MAX_READ_HINT)){
 
 }
-size_t Buffer::ReadableBytes() const{
+template<typename PosPolicy>
+size_t BasicBuffer<PosPolicy>::ReadableBytes() const{
     return write_pos_ - read_pos_;//返回可以写的位置和读的位置之间的长度
 }
 
-size_t Buffer::WriteableBytes() const{
+template<typename PosPolicy>
+size_t BasicBuffer<PosPolicy>::WriteableBytes() const{
     return buffer_.size() - write_pos_;//返回现在缓存的大小减去写入的位置
 }
 
-size_t Buffer::PrependableBytes() const{
+template<typename PosPolicy>
+size_t BasicBuffer<PosPolicy>::PrependableBytes() const{
     return read_pos_;//返回读取的位置
 }
-const char* Buffer::Peek() const{
+template<typename PosPolicy>
+const char* BasicBuffer<PosPolicy>::Peek() const{
     return BeginPtr_() + read_pos_;//返回缓存开始地址加上读取的位置
 }
 
-void Buffer::Retrieve(size_t len){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::Retrieve(size_t len){
     assert(len <= ReadableBytes());//检查是否越界
     read_pos_ += len;//更新读取位置
 }
 
-void Buffer::RetrieveUntil(const char* end){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::RetrieveUntil(const char* end){
     assert(Peek() <= end);//检查参数是否在当前位置之前
     Retrieve(end - Peek());
 }
 
-void Buffer::RetrieveAll(){
-    bzero(&buffer_[0], buffer_.size());//清空缓存的内容
-    //初始化读写位置
+template<typename PosPolicy>
+const char* BasicBuffer<PosPolicy>::FindCRLF(const char* start) const{
+    const char* begin = start ? start : Peek();
+    assert(Peek() <= begin && begin <= BeginWriteConst());
+    return ::FindCRLF(begin, BeginWriteConst());
+}
+
+template<typename PosPolicy>
+const char* BasicBuffer<PosPolicy>::FindAny(const char* set, size_t setLen, const char* start) const{
+    const char* begin = start ? start : Peek();
+    assert(Peek() <= begin && begin <= BeginWriteConst());
+    return ::FindAny(begin, BeginWriteConst(), set, setLen);
+}
+
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::RetrieveAll(){
+    //只重置读写位置，不清空缓存内容
     read_pos_ = 0;
     write_pos_ = 0;
 }
 
-std::string Buffer::RetrieveAllToStr(){
+template<typename PosPolicy>
+std::string BasicBuffer<PosPolicy>::RetrieveAllToStr(){
     std::string str(Peek(),ReadableBytes());//创建缓冲剩余长度的字符串
     RetrieveAll();//清空缓冲
     return str;
 }
 
-const char* Buffer::BeginWriteConst() const{
+template<typename PosPolicy>
+const char* BasicBuffer<PosPolicy>::BeginWriteConst() const{
     return BeginPtr_() + write_pos_;//获取写位置的指针
 }
 
-char* Buffer::BeginWrite(){
+template<typename PosPolicy>
+char* BasicBuffer<PosPolicy>::BeginWrite(){
     return BeginPtr_() + write_pos_;//获取写位置的指针
 }
 
-void Buffer::HasWritten(size_t len){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::HasWritten(size_t len){
     write_pos_ += len;//已经写入修改写的位置
 }
 
-void Buffer::Append(const std::string& str){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::Append(const std::string& str){
     Append(str.data(),str.size());//添加字符串到缓存
 }
 
-void Buffer::Append(const char* str,size_t len){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::Append(const char* str,size_t len){
     assert(str);//断言判断
     EnsureWriteable(len);//确保缓存空间足够写入
     std::copy(str,str + len, BeginWrite());//拷贝字符串到缓存写入的开始地址
     HasWritten(len);//已经写入修改写入位置
 }
 
-void Buffer::Append(const void* data,size_t len){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::Append(const void* data,size_t len){
     assert(data);//断言判断
     Append(static_cast<const char*>(data),len);//转换为字符指针进行写入
 }
 
-void Buffer::Append(const Buffer& buff){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::Append(const BasicBuffer& buff){
     Append(buff.Peek(),buff.ReadableBytes());
 }
 
-void Buffer::EnsureWriteable(size_t len){
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::EnsureWriteable(size_t len){
     if(WriteableBytes() < len){//可以写入的长度小就进行扩容
         MakeSpace_(len);
     }
     assert(WriteableBytes() >= len);//断言判断扩容之后的可写长度足够
 }
 
-ssize_t Buffer::ReadFd(int fd,int* savedErrno){
-    char buff[65536];
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::ReadFd(int fd,int* savedErrno){
+    static_assert(sizeof(read_scratch) == MAX_READ_HINT, "scratch size must match read hint limit");
+    if(ReadableBytes() == 0 && buffer_.size() > std::max(init_size_, read_hint_ * SHRINK_FACTOR)){
+        //缓冲空闲且远大于预计读取量时收缩，避免大量连接各自占着大块内存
+        std::vector<char>(std::max(init_size_, read_hint_ * 2)).swap(buffer_);
+        read_pos_ = 0;
+        write_pos_ = 0;
+        read_stats_.shrinks++;
+        thread_read_stats.shrinks++;
+    }
+    if(WriteableBytes() < read_hint_){//预先准备好可写区域，让数据尽量直接读入缓冲
+        EnsureWriteable(read_hint_);
+        read_stats_.grows++;
+        thread_read_stats.grows++;
+    }
     struct iovec iov[2];
     const size_t writable = WriteableBytes();
     /**进行IO读写的分散**/
     iov[0].iov_base = BeginPtr_() + write_pos_;//写入位置的指针作为缓存开始
     iov[0].iov_len = writable;
-    iov[1].iov_base = buff;//以缓存类的开始作为开始
-    iov[1].iov_len = sizeof(buff);
+    iov[1].iov_base = read_scratch;//放不下的部分读到线程临时缓冲
+    iov[1].iov_len = sizeof(read_scratch);
     const ssize_t len = readv(fd,iov,2);//分聚读取文件描述符的内容到
+    read_stats_.reads++;
+    thread_read_stats.reads++;
     if(len < 0){//判断是否读取错误
         *savedErrno = errno;
-    }else if(static_cast<size_t>(len) <= writable){//读取的内容全部到了缓存类里面了
+        return len;
+    }
+    const bool overflow = static_cast<size_t>(len) > writable;
+    if(!overflow){//读取的内容全部到了缓存类里面了
         write_pos_ += len;
     }else{//有数据读取到了临时的缓存变量里面了
         write_pos_ = buffer_.size();
-        Append(buff,len - writable);
+        Append(read_scratch,len - writable);
+        read_stats_.overflows++;
+        thread_read_stats.overflows++;
     }
+    read_stats_.bytes += len;
+    thread_read_stats.bytes += len;
+    UpdateReadHint_(len, overflow);
     return len;
 }   
 
-ssize_t Buffer::WriteFd(int fd,int* savedErrno){
+template<typename PosPolicy>
+const BufferReadStats& BasicBuffer<PosPolicy>::ThreadReadStats(){
+    return thread_read_stats;
+}
+
+template<typename PosPolicy>
+void BasicBuffer<PosPolicy>::UpdateReadHint_(size_t len, bool overflow){
+    if(overflow){//溢出说明预计偏小，直接翻倍
+        read_hint_ = std::min(std::max(read_hint_ * 2, len), MAX_READ_HINT);
+    }else if(len > 0){//否则向两倍的本次读取量缓慢靠拢
+        read_hint_ = (read_hint_ * 7 + std::min(len * 2, MAX_READ_HINT)) / 8;
+        read_hint_ = std::max(read_hint_, MIN_READ_HINT);
+    }
+}
+
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::WriteFd(int fd,int* savedErrno){
     size_t read_size = ReadableBytes();//获取可以读取缓存的长度
     ssize_t len = write(fd,Peek(),read_size);//把缓存内容写入到文件
     if(len <= 0){//写入失败
@@ -128,31 +206,83 @@ ssize_t Buffer::WriteFd(int fd,int* savedErrno){
     return len;
 }
 
-ssize_t Buffer::ReadFile(FILE *fp) {     
-    char buff[65536];
-    int index = 0;
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::WriteFdWith(int fd,const struct iovec* extra,int extraCount,int* savedErrno){
+    struct iovec iov[1 + MAX_EXTRA_IOV];
+    assert(extraCount >= 0 && extraCount <= MAX_EXTRA_IOV);
+    const size_t read_size = ReadableBytes();
+    int n = 0;
+    if(read_size > 0){//缓冲里的内容放在最前面
+        iov[n].iov_base = const_cast<char*>(Peek());
+        iov[n].iov_len = read_size;
+        n++;
+    }
+    for(int i = 0; i < extraCount; i++){
+        iov[n++] = extra[i];
+    }
+    ssize_t len = writev(fd,iov,n);//一次写出缓冲和外部数据
+    if(len <= 0){//写入失败
+        *savedErrno = errno;
+        return len;
+    }
+    read_pos_ += std::min(static_cast<size_t>(len), read_size);//只修改缓冲部分的读取位置
+    return len;
+}
+
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::ReadFile(FILE *fp) {     
+    ssize_t total = 0;
     while (true)
     {
-        int character = fgetc(fp);
-        if(character==EOF){
+        EnsureWriteable(FILE_READ_STEP);//每次至少准备一段空间整块读取
+        size_t n = fread(BeginWrite(),1,WriteableBytes(),fp);
+        HasWritten(n);
+        total += n;
+        if(n == 0){
+            break;
+        }
+    }
+    return total;
+}
+
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::ReadFile(int fd,size_t maxLen,int* savedErrno) {
+    ssize_t total = 0;
+    while (static_cast<size_t>(total) < maxLen)
+    {
+        EnsureWriteable(std::min(FILE_READ_STEP,maxLen - total));
+        size_t want = std::min(WriteableBytes(),maxLen - total);
+        ssize_t n = read(fd,BeginWrite(),want);//直接读入缓冲，不经过stdio
+        if(n < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            *savedErrno = errno;
+            return total > 0 ? total : n;
+        }
+        if(n == 0){//文件结束
             break;
         }
-        buff[index++] = character;
+        HasWritten(n);
+        total += n;
     }
-    Append(buff,index); 
-    return index;
+    return total;
 }
 
-ssize_t Buffer::WriteFile(FILE *fp) { 
-    size_t write_size =  fwrite(BeginPtr_()+write_pos_,1,ReadableBytes(),fp);
+template<typename PosPolicy>
+ssize_t BasicBuffer<PosPolicy>::WriteFile(FILE *fp) { 
+    size_t write_size =  fwrite(Peek(),1,ReadableBytes(),fp);
     return write_size;
  }
 
- char *Buffer::BeginPtr_() { return &*buffer_.begin(); }
+ template<typename PosPolicy>
+ char *BasicBuffer<PosPolicy>::BeginPtr_() { return &*buffer_.begin(); }
 
- const char *Buffer::BeginPtr_() const { return &*buffer_.begin(); }
+ template<typename PosPolicy>
+ const char *BasicBuffer<PosPolicy>::BeginPtr_() const { return &*buffer_.begin(); }
 
- void Buffer::MakeSpace_(size_t len) {
+ template<typename PosPolicy>
+ void BasicBuffer<PosPolicy>::MakeSpace_(size_t len) {
    if (WriteableBytes() + PrependableBytes() <
        len) { // 缓存整个的空间不足就考虑扩容
      buffer_.resize(write_pos_ + len);
@@ -163,4 +293,7 @@ ssize_t Buffer::WriteFile(FILE *fp) {
      read_pos_ = 0;                     // 读取位置归零
      write_pos_ = read_pos_ + readable; // 写入位置为当前缓存数据的长度
    }
-}
\ No newline at end of file
+}
+
+template class BasicBuffer<SingleOwnerPolicy>;
+template class BasicBuffer<AtomicPosPolicy>;
@@ -13,23 +13,51 @@
 #include <cstddef>
 #include <cstdio>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <vector>
 #include <string>
 #ifndef _BUFFER_HPP_
 #define _BUFFER_HPP_
+/**
+ * @brief ReadFd的读取统计
+ * 
+ */
+struct BufferReadStats{
+    size_t reads = 0;//readv调用次数
+    size_t bytes = 0;//读取的总字节数
+    size_t overflows = 0;//数据溢出到线程临时缓冲的次数
+    size_t grows = 0;//读取前预先扩大可写区域的次数
+    size_t shrinks = 0;//空闲时收缩缓冲的次数
+};
+/**
+ * @brief 单一所有者的读写位置策略，读写位置为普通整数
+ * 
+ */
+struct SingleOwnerPolicy{
+    typedef std::size_t PosType;
+};
+/**
+ * @brief 多线程共享的读写位置策略，读写位置为原子变量
+ * 
+ */
+struct AtomicPosPolicy{
+    typedef std::atomic<std::size_t> PosType;
+};
 /**
  * @brief 字符缓冲类
  * 
+ * @tparam PosPolicy 读写位置的存储策略
  */
-class Buffer{
+template<typename PosPolicy>
+class BasicBuffer{
     public:
         /**
          * @brief 构造函数根据初始化容量创建缓冲
          * 
          * @param initBufferSize 缓冲尺寸
          */
-        Buffer(size_t initBufferSize = 1024);
-        ~Buffer()=default;
+        BasicBuffer(size_t initBufferSize = 1024);
+        ~BasicBuffer()=default;
         /**
          * @brief 获取可写字节数
          * 
@@ -79,7 +107,23 @@ class Buffer{
          */
         void RetrieveUntil(const char* end);
         /**
-         * @brief 读取到末尾
+         * @brief 在可读数据中查找\r\n
+         * 
+         * @param start 开始查找的位置，为空时从Peek()开始
+         * @return const char* 指向\r，没有时为空
+         */
+        const char* FindCRLF(const char* start = nullptr) const;
+        /**
+         * @brief 在可读数据中查找第一个属于set的字节
+         * 
+         * @param set 
+         * @param setLen 不超过16
+         * @param start 开始查找的位置，为空时从Peek()开始
+         * @return const char* 没有时为空
+         */
+        const char* FindAny(const char* set, size_t setLen, const char* start = nullptr) const;
+        /**
+         * @brief 读取到末尾，只重置读写位置
          * 
          */
         void RetrieveAll();
@@ -126,15 +170,31 @@ class Buffer{
          * 
          * @param buffer 
          */
-        void Append(const Buffer& buffer);
+        void Append(const BasicBuffer& buffer);
         /**
          * @brief 读取文件描述符
+         * 根据历史读取量预先调整可写区域，尽量让一次readv直接读入缓冲，
+         * 放不下的部分先读入线程共享的临时缓冲再追加
          * 
          * @param fd 
          * @param savedErrno 
          * @return ssize_t 
          */
         ssize_t ReadFd(int fd, int* savedErrno);
+        /**
+         * @brief 获取本缓冲的读取统计
+         * 
+         * @return const BufferReadStats& 
+         */
+        const BufferReadStats& ReadStats() const{
+            return read_stats_;
+        }
+        /**
+         * @brief 获取当前线程所有缓冲的读取统计
+         * 
+         * @return const BufferReadStats& 
+         */
+        static const BufferReadStats& ThreadReadStats();
         /**
          * @brief 写入文件描述符
          * 
@@ -143,6 +203,16 @@ class Buffer{
          * @return ssize_t 
          */
         ssize_t WriteFd(int fd, int* savedErrno);
+        /**
+         * @brief 先写出缓冲内容，再接着写出extra指向的数据，只用一次writev
+         * 
+         * @param fd 
+         * @param extra 缓冲之后要写出的数据
+         * @param extraCount extra的个数，不超过MAX_EXTRA_IOV
+         * @param savedErrno 
+         * @return ssize_t 写出的总字节数，缓冲部分会被读取
+         */
+        ssize_t WriteFdWith(int fd, const struct iovec* extra, int extraCount, int* savedErrno);
         /**
          * @brief 读取文件指针内容到缓存
          * 
@@ -150,6 +220,15 @@ class Buffer{
          * @return ssize_t 
          */
         ssize_t ReadFile(FILE* fp);
+        /**
+         * @brief 用read把文件描述符的内容整段读入缓存
+         * 
+         * @param fd 
+         * @param maxLen 最多读取的字节数
+         * @param savedErrno 
+         * @return ssize_t 
+         */
+        ssize_t ReadFile(int fd, size_t maxLen, int* savedErrno);
         /**
          * @brief 写入缓存内容到文件指针的文件
          * 
@@ -157,7 +236,19 @@ class Buffer{
          * @return ssize_t 
          */
         ssize_t WriteFile(FILE*fp);
+        static constexpr int MAX_EXTRA_IOV = 7;//WriteFdWith最多附带的外部数据段数
     private:
+        static constexpr size_t FILE_READ_STEP = 16384;//读取文件时每次准备的空间
+        static constexpr size_t MIN_READ_HINT = 512;//预计读取量的下限
+        static constexpr size_t MAX_READ_HINT = 65536;//预计读取量的上限，也是线程临时缓冲的大小
+        static constexpr size_t SHRINK_FACTOR = 4;//空闲缓冲超过预计读取量的倍数就收缩
+        /**
+         * @brief 根据本次读取量更新预计读取量
+         * 
+         * @param len 
+         * @param overflow 
+         */
+        void UpdateReadHint_(size_t len, bool overflow);
         char* BeginPtr_();
         const char* BeginPtr_() const;
         /**
@@ -167,7 +258,15 @@ class Buffer{
          */
         void MakeSpace_(size_t len);
         std::vector<char> buffer_;//缓冲存储的容器
-        std::atomic<std::size_t> read_pos_;//读取位置原子变量
-        std::atomic<std::size_t> write_pos_;//写入位置原子变量
+        typename PosPolicy::PosType read_pos_;//读取位置
+        typename PosPolicy::PosType write_pos_;//写入位置
+        size_t init_size_;//初始容量，收缩时不低于这个值
+        size_t read_hint_;//预计下一次读取的字节数
+        BufferReadStats read_stats_;//读取统计
 };
+//连接和日志的缓冲都只被一个所有者使用，默认不使用原子变量
+typedef BasicBuffer<SingleOwnerPolicy> Buffer;
+typedef BasicBuffer<AtomicPosPolicy> AtomicBuffer;
+extern template class BasicBuffer<SingleOwnerPolicy>;
+extern template class BasicBuffer<AtomicPosPolicy>;
 #endif
\ No newline at end of file
@@ -0,0 +1,339 @@
+/**
+ * @file chain_buffer.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "chain_buffer.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+namespace {
+thread_local char read_scratch[65536];//同一线程所有链式缓冲共享的溢出临时缓冲
+}
+
+ChainBuffer::~ChainBuffer(){
+    RetrieveAll();
+}
+
+ChainBuffer::ChainBuffer(ChainBuffer&& other) noexcept
+    :head_(other.head_),tail_(other.tail_),readable_(other.readable_),last_read_(other.last_read_){
+    other.head_ = nullptr;
+    other.tail_ = nullptr;
+    other.readable_ = 0;
+}
+
+ChainBuffer& ChainBuffer::operator=(ChainBuffer&& other) noexcept{
+    if(this != &other){
+        RetrieveAll();
+        head_ = other.head_;
+        tail_ = other.tail_;
+        readable_ = other.readable_;
+        last_read_ = other.last_read_;
+        other.head_ = nullptr;
+        other.tail_ = nullptr;
+        other.readable_ = 0;
+    }
+    return *this;
+}
+
+size_t ChainBuffer::WriteableBytes() const{
+    return tail_ ? tail_->WriteableBytes() : 0;//只有尾块可以写入
+}
+
+size_t ChainBuffer::ReadableBytes() const{
+    return readable_;
+}
+
+size_t ChainBuffer::PrependableBytes() const{
+    return head_ ? head_->read_pos : 0;
+}
+
+const char* ChainBuffer::Peek() const{
+    return Peek(readable_);
+}
+
+const char* ChainBuffer::Peek(size_t len) const{
+    static const char empty[1] = {0};
+    if(!head_){
+        return empty;
+    }
+    len = std::min(len, readable_);
+    if(head_->ReadableBytes() < len){//需要的数据跨块，只合并这一部分
+        Pullup_(len);
+    }
+    return head_->Data() + head_->read_pos;
+}
+
+void ChainBuffer::EnsureWriteable(size_t len){
+    if(tail_ && tail_->WriteableBytes() >= len){
+        return;
+    }
+    if(tail_ && tail_->ReadableBytes() == 0 && tail_->capacity >= len){//尾块没有数据就直接复用
+        tail_->read_pos = 0;
+        tail_->write_pos = 0;
+        return;
+    }
+    PushBack_(SlabPool::Local().Allocate(len));
+    assert(WriteableBytes() >= len);
+}
+
+void ChainBuffer::HasWritten(size_t len){
+    assert(tail_ && len <= tail_->WriteableBytes());
+    tail_->write_pos += len;
+    readable_ += len;
+}
+
+void ChainBuffer::Retrieve(size_t len){
+    assert(len <= readable_);//检查是否越界
+    readable_ -= len;
+    SlabPool& pool = SlabPool::Local();
+    while(head_){
+        size_t n = std::min(len, head_->ReadableBytes());
+        head_->read_pos += n;
+        len -= n;
+        if(head_->ReadableBytes() > 0){
+            break;
+        }
+        if(head_ == tail_){//最后一个块读完后留作写入
+            head_->read_pos = 0;
+            head_->write_pos = 0;
+            break;
+        }
+        BufferChunk* chunk = head_;
+        head_ = chunk->next;
+        pool.Free(chunk);
+    }
+    assert(len == 0);
+}
+
+void ChainBuffer::RetrieveUntil(const char* end){
+    assert(Peek() <= end);//检查参数是否在当前位置之前
+    Retrieve(end - Peek());
+}
+
+void ChainBuffer::RetrieveAll(){
+    SlabPool& pool = SlabPool::Local();
+    while(head_){
+        BufferChunk* chunk = head_;
+        head_ = chunk->next;
+        pool.Free(chunk);
+    }
+    tail_ = nullptr;
+    readable_ = 0;
+}
+
+std::string ChainBuffer::RetrieveAllToStr(){
+    std::string str;
+    str.reserve(readable_);
+    for(BufferChunk* chunk = head_; chunk; chunk = chunk->next){
+        str.append(chunk->Data() + chunk->read_pos, chunk->ReadableBytes());
+    }
+    RetrieveAll();
+    return str;
+}
+
+const char* ChainBuffer::BeginWriteConst() const{
+    return tail_ ? tail_->Data() + tail_->write_pos : nullptr;
+}
+
+char* ChainBuffer::BeginWrite(){
+    if(!tail_){
+        PushBack_(SlabPool::Local().Allocate());
+    }
+    return tail_->Data() + tail_->write_pos;
+}
+
+void ChainBuffer::Append(const std::string& str){
+    Append(str.data(), str.size());
+}
+
+void ChainBuffer::Append(const char* str, size_t len){
+    assert(str || len == 0);
+    SlabPool& pool = SlabPool::Local();
+    while(len > 0){
+        if(!tail_ || tail_->WriteableBytes() == 0){
+            PushBack_(pool.Allocate());
+        }
+        size_t n = std::min(len, tail_->WriteableBytes());
+        memcpy(tail_->Data() + tail_->write_pos, str, n);
+        tail_->write_pos += n;
+        readable_ += n;
+        str += n;
+        len -= n;
+    }
+}
+
+void ChainBuffer::Append(const void* data, size_t len){
+    Append(static_cast<const char*>(data), len);
+}
+
+void ChainBuffer::Append(const ChainBuffer& buffer){
+    for(BufferChunk* chunk = buffer.head_; chunk; chunk = chunk->next){
+        Append(chunk->Data() + chunk->read_pos, chunk->ReadableBytes());
+    }
+}
+
+void ChainBuffer::Splice(ChainBuffer& buffer){
+    if(&buffer == this || !buffer.head_){
+        return;
+    }
+    if(tail_){
+        tail_->next = buffer.head_;
+    }else{
+        head_ = buffer.head_;
+    }
+    tail_ = buffer.tail_;
+    readable_ += buffer.readable_;
+    buffer.head_ = nullptr;
+    buffer.tail_ = nullptr;
+    buffer.readable_ = 0;
+}
+
+int ChainBuffer::GetReadIovec(struct iovec* iov, int max_iov) const{
+    int n = 0;
+    for(BufferChunk* chunk = head_; chunk && n < max_iov; chunk = chunk->next){
+        if(chunk->ReadableBytes() == 0){
+            continue;
+        }
+        iov[n].iov_base = chunk->Data() + chunk->read_pos;
+        iov[n].iov_len = chunk->ReadableBytes();
+        n++;
+    }
+    return n;
+}
+
+ssize_t ChainBuffer::ReadFd(int fd, int* savedErrno){
+    SlabPool& pool = SlabPool::Local();
+    if(WriteableBytes() == 0){//尾块写满或者还没有块时才申请新块
+        PushBack_(pool.Allocate());
+    }
+    struct iovec iov[MAX_READ_CHUNKS + 2];
+    BufferChunk* spare[MAX_READ_CHUNKS];
+    const size_t writable = tail_->WriteableBytes();
+    iov[0].iov_base = tail_->Data() + tail_->write_pos;
+    iov[0].iov_len = writable;
+    int spares = 0;//按上次读取量预备新块，读取量小的连接一个也不申请
+    for(size_t room = writable; room < last_read_ && spares < MAX_READ_CHUNKS; room += SlabPool::CHUNK_DATA_SIZE){
+        spare[spares] = pool.Allocate();
+        iov[spares + 1].iov_base = spare[spares]->Data();
+        iov[spares + 1].iov_len = spare[spares]->capacity;
+        spares++;
+    }
+    iov[spares + 1].iov_base = read_scratch;//还放不下的部分读到线程临时缓冲
+    iov[spares + 1].iov_len = sizeof(read_scratch);
+    const ssize_t len = readv(fd, iov, spares + 2);
+    if(len < 0){
+        *savedErrno = errno;
+        for(int i = 0; i < spares; i++){
+            pool.Free(spare[i]);
+        }
+        return len;
+    }
+    last_read_ = static_cast<size_t>(len);
+    size_t remain = last_read_;
+    size_t n = std::min(remain, writable);
+    HasWritten(n);
+    remain -= n;
+    for(int i = 0; i < spares; i++){//用到的块挂到链表上，其余的归还
+        if(remain > 0){
+            n = std::min(remain, spare[i]->capacity);
+            spare[i]->write_pos = n;
+            readable_ += n;
+            remain -= n;
+            PushBack_(spare[i]);
+        }else{
+            pool.Free(spare[i]);
+        }
+    }
+    if(remain > 0){
+        Append(read_scratch, remain);
+    }
+    return len;
+}
+
+ssize_t ChainBuffer::WriteFd(int fd, int* savedErrno){
+    struct iovec iov[MAX_WRITE_IOV];
+    int n = GetReadIovec(iov, MAX_WRITE_IOV);
+    ssize_t len = writev(fd, iov, n);//聚合写出所有块
+    if(len <= 0){//写入失败
+        *savedErrno = errno;
+        return len;
+    }
+    Retrieve(len);
+    return len;
+}
+
+ssize_t ChainBuffer::ReadFile(FILE* fp){
+    ssize_t total = 0;
+    while(true){
+        if(WriteableBytes() == 0){
+            PushBack_(SlabPool::Local().Allocate());
+        }
+        size_t n = fread(BeginWrite(), 1, WriteableBytes(), fp);
+        HasWritten(n);
+        total += n;
+        if(n == 0){
+            break;
+        }
+    }
+    return total;
+}
+
+ssize_t ChainBuffer::WriteFile(FILE* fp){
+    ssize_t total = 0;
+    for(BufferChunk* chunk = head_; chunk; chunk = chunk->next){
+        total += fwrite(chunk->Data() + chunk->read_pos, 1, chunk->ReadableBytes(), fp);
+    }
+    return total;
+}
+
+void ChainBuffer::PushBack_(BufferChunk* chunk){
+    chunk->next = nullptr;
+    if(tail_){
+        tail_->next = chunk;
+    }else{
+        head_ = chunk;
+    }
+    tail_ = chunk;
+}
+
+void ChainBuffer::Pullup_(size_t len) const{
+    SlabPool& pool = SlabPool::Local();
+    BufferChunk* dst = head_;
+    const size_t have = head_->ReadableBytes();
+    if(dst->capacity < len){//首块放不下就申请一个足够大的块
+        dst = pool.Allocate(len);
+        memcpy(dst->Data(), head_->Data() + head_->read_pos, have);
+        dst->write_pos = have;
+        dst->next = head_->next;
+        pool.Free(head_);
+    }else if(dst->capacity - dst->read_pos < len){//首块后面的空间不够时先把数据移到块首
+        memmove(dst->Data(), dst->Data() + dst->read_pos, have);
+        dst->read_pos = 0;
+        dst->write_pos = have;
+    }
+    BufferChunk* chunk = dst->next;
+    while(dst->ReadableBytes() < len){
+        size_t n = std::min(len - dst->ReadableBytes(), chunk->ReadableBytes());
+        memcpy(dst->Data() + dst->write_pos, chunk->Data() + chunk->read_pos, n);
+        dst->write_pos += n;
+        chunk->read_pos += n;
+        if(chunk->ReadableBytes() == 0){//取空的块归还
+            BufferChunk* next = chunk->next;
+            if(chunk == tail_){
+                tail_ = dst;
+            }
+            pool.Free(chunk);
+            chunk = next;
+        }
+    }
+    dst->next = chunk;
+    head_ = dst;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file chain_buffer.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 分段链式缓冲
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _CHAIN_BUFFER_HPP_
+#define _CHAIN_BUFFER_HPP_
+#include "slab_pool.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <sys/types.h>
+#include <sys/uio.h>
+/**
+ * @brief 链式缓冲类
+ * 数据保存在从线程本地slab池取得的定长块链表中，追加数据和读取文件描述符不会搬移已有数据；
+ * 接口与Buffer保持一致，Peek在可读数据跨块时才把数据合并到一个连续块中，
+ * Peek(len)只合并前len字节
+ */
+class ChainBuffer{
+    public:
+        ChainBuffer() = default;
+        ~ChainBuffer();
+        ChainBuffer(ChainBuffer&& other) noexcept;
+        ChainBuffer& operator=(ChainBuffer&& other) noexcept;
+        ChainBuffer(const ChainBuffer&) = delete;
+        ChainBuffer& operator=(const ChainBuffer&) = delete;
+        /**
+         * @brief 获取尾块中连续的可写字节数
+         *
+         * @return size_t
+         */
+        size_t WriteableBytes() const;
+        /**
+         * @brief 获取可读字节数
+         *
+         * @return size_t
+         */
+        size_t ReadableBytes() const;
+        /**
+         * @brief 获取首块中已经读取过的字节数
+         *
+         * @return size_t
+         */
+        size_t PrependableBytes() const;
+        /**
+         * @brief 获取可读数据的连续首地址，数据跨块时会先合并
+         *
+         * @return const char*
+         */
+        const char* Peek() const;
+        /**
+         * @brief 获取可读数据的首地址，保证前len字节连续，只合并这一部分
+         *
+         * @param len 超过可读字节数时按可读字节数处理
+         * @return const char*
+         */
+        const char* Peek(size_t len) const;
+        /**
+         * @brief 确保尾块有len字节的连续可写空间
+         *
+         * @param len
+         */
+        void EnsureWriteable(size_t len);
+        /**
+         * @brief 已写入指定长度，修改写指针
+         *
+         * @param len
+         */
+        void HasWritten(size_t len);
+        /**
+         * @brief 读取指定长度数据
+         *
+         * @param len
+         */
+        void Retrieve(size_t len);
+        /**
+         * @brief 读取到指定位置，end必须在Peek返回的连续区域内
+         *
+         * @param end
+         */
+        void RetrieveUntil(const char* end);
+        /**
+         * @brief 读取到末尾并归还所有块
+         *
+         */
+        void RetrieveAll();
+        /**
+         * @brief 获取缓冲剩余
+         *
+         * @return std::string
+         */
+        std::string RetrieveAllToStr();
+        /**
+         * @brief 获取缓冲写首地址
+         *
+         * @return const char*
+         */
+        const char* BeginWriteConst() const;
+        /**
+         * @brief 获取缓冲写首地址
+         *
+         * @return char*
+         */
+        char* BeginWrite();
+        /**
+         * @brief 缓冲写入字符串
+         *
+         * @param str
+         */
+        void Append(const std::string& str);
+        /**
+         * @brief 缓冲写入字符串
+         *
+         * @param str
+         * @param len
+         */
+        void Append(const char* str, size_t len);
+        /**
+         * @brief 缓冲写入
+         *
+         * @param data
+         * @param len
+         */
+        void Append(const void* data, size_t len);
+        /**
+         * @brief 缓冲写入
+         *
+         * @param buffer
+         */
+        void Append(const ChainBuffer& buffer);
+        /**
+         * @brief 不拷贝地把另一个缓冲的所有块接到尾部
+         *
+         * @param buffer
+         */
+        void Splice(ChainBuffer& buffer);
+        /**
+         * @brief 把可读数据按块填入iovec，不拷贝
+         *
+         * @param iov
+         * @param max_iov
+         * @return int 填入的iovec个数
+         */
+        int GetReadIovec(struct iovec* iov, int max_iov) const;
+        /**
+         * @brief 读取文件描述符，数据先读入尾块，尾块写满时才申请一个新块；
+         * 再按上次的读取量预备新块，仍然放不下的部分经线程临时缓冲追加
+         *
+         * @param fd
+         * @param savedErrno
+         * @return ssize_t
+         */
+        ssize_t ReadFd(int fd, int* savedErrno);
+        /**
+         * @brief 以writev写入文件描述符
+         *
+         * @param fd
+         * @param savedErrno
+         * @return ssize_t
+         */
+        ssize_t WriteFd(int fd, int* savedErrno);
+        /**
+         * @brief 读取文件指针内容到缓存
+         *
+         * @param fp
+         * @return ssize_t
+         */
+        ssize_t ReadFile(FILE* fp);
+        /**
+         * @brief 写入缓存内容到文件指针的文件
+         *
+         * @param fp
+         * @return ssize_t
+         */
+        ssize_t WriteFile(FILE* fp);
+    private:
+        static constexpr int MAX_READ_CHUNKS = 16;//一次ReadFd最多预备的新块数
+        static constexpr int MAX_WRITE_IOV = 64;//一次WriteFd最多聚合的块数
+        /**
+         * @brief 在尾部挂上一个块
+         *
+         * @param chunk
+         */
+        void PushBack_(BufferChunk* chunk);
+        /**
+         * @brief 把前len字节合并到首块，后面块中被取走的部分直接从链表中扣除
+         *
+         * @param len 不超过可读字节数
+         */
+        void Pullup_(size_t len) const;
+        //Peek需要在const下合并数据，所以链表状态都是mutable
+        mutable BufferChunk* head_ = nullptr;//首块
+        mutable BufferChunk* tail_ = nullptr;//尾块
+        size_t readable_ = 0;//所有块的可读字节数
+        size_t last_read_ = 0;//上次ReadFd读到的字节数，决定预备多少新块
+};
+#endif
@@ -0,0 +1,317 @@
+#include "scan.hpp"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_X86 1
+#endif
+namespace {
+/**
+ * @brief 按字节的高低4位查表判断是否属于一个字节集合，标量和向量实现共用
+ * 字节c属于集合当且仅当lo[c&0xf] & hi[c>>4]不为0，hi的第h位对应高4位为h，所以只能表示小于0x80的字节
+ */
+struct NibbleTable{
+    alignas(16) uint8_t lo[16];
+    alignas(16) uint8_t hi[16];
+    constexpr NibbleTable(const char* chars) : lo(), hi(){
+        for(int h = 0; h < 8; h++){
+            hi[h] = static_cast<uint8_t>(1 << h);
+        }
+        for(const char* p = chars; *p; p++){
+            unsigned char c = static_cast<unsigned char>(*p);
+            lo[c & 0xf] |= static_cast<uint8_t>(1 << (c >> 4));
+        }
+    }
+    constexpr bool Has(unsigned char c) const{
+        return (lo[c & 0xf] & hi[c >> 4]) != 0;
+    }
+};
+constexpr NibbleTable TOKEN("!#$%&'*+-.^_`|~0123456789"
+                            "abcdefghijklmnopqrstuvwxyz"
+                            "ABCDEFGHIJKLMNOPQRSTUVWXYZ");
+inline bool IsCtl(unsigned char c, bool allowTab){
+    return (c < 0x20 && !(allowTab && c == '\t')) || c == 0x7f;
+}
+//一次取8个字节，有字节命中时掩码在它的最高位上有标记；借位只会让命中之后的字节多出标记，
+//所以小端上最低的标记就是第一个命中，大端上从这8个字节的开头逐字节确认
+constexpr uint64_t ONES = 0x0101010101010101ULL;
+constexpr uint64_t HIGHS = 0x8080808080808080ULL;
+inline uint64_t Load8(const char* p){
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+inline uint64_t ZeroBytes(uint64_t word){
+    return (word - ONES) & ~word & HIGHS;
+}
+inline uint64_t LessBytes(uint64_t word, uint8_t n){//n不超过0x80
+    return (word - ONES * n) & ~word & HIGHS;
+}
+constexpr bool LITTLE_ENDIAN_WORDS = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+inline size_t FirstMarked(uint64_t mask){
+    return LITTLE_ENDIAN_WORDS ? __builtin_ctzll(mask) >> 3 : 0;
+}
+const char* FindAnyScalar(const char* p, const char* end, const char* set, size_t setLen){
+    uint64_t patterns[16];//setLen不超过16
+    for(size_t i = 0; i < setLen; i++){
+        patterns[i] = ONES * static_cast<unsigned char>(set[i]);
+    }
+    for(; end - p >= 8; p += 8){
+        uint64_t word = Load8(p);
+        uint64_t hit = 0;
+        for(size_t i = 0; i < setLen; i++){
+            hit |= ZeroBytes(word ^ patterns[i]);
+        }
+        if(hit){
+            if(LITTLE_ENDIAN_WORDS){
+                return p + FirstMarked(hit);
+            }
+            break;
+        }
+    }
+    for(; p < end; p++){
+        if(memchr(set, *p, setLen)){
+            return p;
+        }
+    }
+    return nullptr;
+}
+const char* FindNonTokenScalar(const char* p, const char* end){
+    for(; p < end; p++){
+        if(!TOKEN.Has(static_cast<unsigned char>(*p))){
+            return p;
+        }
+    }
+    return nullptr;
+}
+const char* FindCtlScalar(const char* p, const char* end, bool allowTab){
+    while(p < end){
+        const char* stop = end;
+        for(; end - p >= 8; p += 8){
+            uint64_t word = Load8(p);
+            uint64_t hit = LessBytes(word, 0x20) | ZeroBytes(word ^ (ONES * 0x7f));
+            if(hit){
+                stop = p + 8;
+                p += FirstMarked(hit);
+                break;
+            }
+        }
+        for(; p < stop; p++){//命中的可能是允许的制表符，这时从这8个字节之后继续
+            if(IsCtl(static_cast<unsigned char>(*p), allowTab)){
+                return p;
+            }
+        }
+    }
+    return nullptr;
+}
+#ifdef SCAN_X86
+//向量循环每次处理一整个寄存器，不足一个寄存器的尾部交给低一级的实现；
+//AVX2转到SSE之前要清零高位，否则SSE指令会因为寄存器状态转换变慢好几倍
+__attribute__((target("sse4.2")))
+const char* FindAnySse42(const char* p, const char* end, const char* set, size_t setLen){
+    alignas(16) char chars[16] = {};
+    memcpy(chars, set, setLen);
+    const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i*>(chars));
+    const int n = static_cast<int>(setLen);
+    while(end - p >= 16){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int i = _mm_cmpestri(s, n, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT);
+        if(i < 16){
+            return p + i;
+        }
+        p += 16;
+    }
+    return FindAnyScalar(p, end, set, setLen);
+}
+__attribute__((target("sse4.2")))
+const char* FindNonTokenSse42(const char* p, const char* end){
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN.lo));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN.hi));
+    const __m128i nibble = _mm_set1_epi8(0x0f);
+    const __m128i zero = _mm_setzero_si128();
+    while(end - p >= 16){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(v, nibble));
+        __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(l, h), zero));
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return FindNonTokenScalar(p, end);
+}
+__attribute__((target("sse4.2")))
+const char* FindCtlSse42(const char* p, const char* end, bool allowTab){
+    const __m128i space = _mm_set1_epi8(0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i tab = _mm_set1_epi8(allowTab ? '\t' : 0x7f);
+    while(end - p >= 16){
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i printable = _mm_cmpeq_epi8(_mm_max_epu8(v, space), v);//v >= 0x20
+        __m128i ctl = _mm_andnot_si128(printable, _mm_cmpeq_epi8(v, v));
+        ctl = _mm_andnot_si128(_mm_cmpeq_epi8(v, tab), ctl);//不允许制表符时tab是0x7f，这一步不起作用
+        ctl = _mm_or_si128(ctl, _mm_cmpeq_epi8(v, del));
+        int mask = _mm_movemask_epi8(ctl);
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+    return FindCtlScalar(p, end, allowTab);
+}
+__attribute__((target("avx2")))
+const char* FindAnyAvx2(const char* p, const char* end, const char* set, size_t setLen){
+    __m256i chars[16];
+    for(size_t i = 0; i < setLen; i++){
+        chars[i] = _mm256_set1_epi8(set[i]);
+    }
+    while(end - p >= 32){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hit = _mm256_cmpeq_epi8(v, chars[0]);
+        for(size_t i = 1; i < setLen; i++){
+            hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, chars[i]));
+        }
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit));
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    _mm256_zeroupper();
+    return FindAnySse42(p, end, set, setLen);
+}
+__attribute__((target("avx2")))
+const char* FindNonTokenAvx2(const char* p, const char* end){
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN.lo)));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(TOKEN.hi)));
+    const __m256i nibble = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    while(end - p >= 32){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(v, nibble));
+        __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(l, h), zero)));
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    _mm256_zeroupper();
+    return FindNonTokenSse42(p, end);
+}
+__attribute__((target("avx2")))
+const char* FindCtlAvx2(const char* p, const char* end, bool allowTab){
+    const __m256i space = _mm256_set1_epi8(0x20);
+    const __m256i del = _mm256_set1_epi8(0x7f);
+    const __m256i tab = _mm256_set1_epi8(allowTab ? '\t' : 0x7f);
+    while(end - p >= 32){
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i printable = _mm256_cmpeq_epi8(_mm256_max_epu8(v, space), v);
+        __m256i ctl = _mm256_andnot_si256(printable, _mm256_cmpeq_epi8(v, v));
+        ctl = _mm256_andnot_si256(_mm256_cmpeq_epi8(v, tab), ctl);
+        ctl = _mm256_or_si256(ctl, _mm256_cmpeq_epi8(v, del));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(ctl));
+        if(mask){
+            return p + __builtin_ctz(mask);
+        }
+        p += 32;
+    }
+    _mm256_zeroupper();
+    return FindCtlSse42(p, end, allowTab);
+}
+#endif
+/**
+ * @brief 一种指令集的全部实现
+ *
+ */
+struct ScanOps{
+    SCAN_ISA isa;
+    const char* (*findAny)(const char*, const char*, const char*, size_t);
+    const char* (*findNonToken)(const char*, const char*);
+    const char* (*findCtl)(const char*, const char*, bool);
+};
+const ScanOps OPS[] = {
+    {SCAN_SCALAR, FindAnyScalar, FindNonTokenScalar, FindCtlScalar},
+#ifdef SCAN_X86
+    {SCAN_SSE42, FindAnySse42, FindNonTokenSse42, FindCtlSse42},
+    {SCAN_AVX2, FindAnyAvx2, FindNonTokenAvx2, FindCtlAvx2},
+#endif
+};
+std::atomic<const ScanOps*> g_ops{nullptr};
+SCAN_ISA DetectIsa(){
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        return SCAN_AVX2;
+    }
+    if(__builtin_cpu_supports("sse4.2")){
+        return SCAN_SSE42;
+    }
+#endif
+    return SCAN_SCALAR;
+}
+constexpr ptrdiff_t SHORT_SCAN = 16;//比一个SSE寄存器短的范围直接用标量实现，省掉分派和逐级转交
+inline const ScanOps* Ops(){
+    const ScanOps* ops = g_ops.load(std::memory_order_relaxed);
+    if(!ops){//各个线程选出的结果相同，重复初始化没有关系
+        ops = &OPS[DetectIsa()];
+        g_ops.store(ops, std::memory_order_relaxed);
+    }
+    return ops;
+}
+}
+SCAN_ISA ScanIsa(){
+    return Ops()->isa;
+}
+SCAN_ISA SetScanIsa(SCAN_ISA isa){
+    SCAN_ISA best = DetectIsa();
+    if(isa > best){
+        isa = best;
+    }
+    g_ops.store(&OPS[isa], std::memory_order_relaxed);
+    return isa;
+}
+const char* FindCRLF(const char* begin, const char* end){
+    //glibc的memchr已经按CPU选好了向量实现，找\n再看前一个字节比自己同时比较两个字节快，不走指令集分派
+    if(end - begin < 2){
+        return nullptr;
+    }
+    const char* p = begin + 1;
+    while(p < end){
+        const char* lf = static_cast<const char*>(memchr(p, '\n', end - p));
+        if(!lf){
+            return nullptr;
+        }
+        if(lf[-1] == '\r'){
+            return lf - 1;
+        }
+        p = lf + 1;
+    }
+    return nullptr;
+}
+const char* FindAny(const char* begin, const char* end, const char* set, size_t setLen){
+    if(setLen == 0 || setLen > 16){
+        return nullptr;
+    }
+    if(setLen == 1){
+        return static_cast<const char*>(memchr(begin, set[0], end - begin));
+    }
+    if(end - begin < SHORT_SCAN){
+        return FindAnyScalar(begin, end, set, setLen);
+    }
+    return Ops()->findAny(begin, end, set, setLen);
+}
+const char* FindNonToken(const char* begin, const char* end){
+    if(end - begin < SHORT_SCAN){
+        return FindNonTokenScalar(begin, end);
+    }
+    return Ops()->findNonToken(begin, end);
+}
+const char* FindCtl(const char* begin, const char* end, bool allowTab){
+    if(end - begin < SHORT_SCAN){
+        return FindCtlScalar(begin, end, allowTab);
+    }
+    return Ops()->findCtl(begin, end, allowTab);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file scan.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 向量化的分隔符查找
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _SCAN_HPP_
+#define _SCAN_HPP_
+#include <cstddef>
+/**
+ * @brief 查找使用的指令集，第一次调用时按CPU支持的最高级别选择
+ *
+ */
+enum SCAN_ISA{
+    SCAN_SCALAR = 0,
+    SCAN_SSE42,
+    SCAN_AVX2
+};
+/**
+ * @brief 当前使用的指令集
+ *
+ * @return SCAN_ISA
+ */
+SCAN_ISA ScanIsa();
+/**
+ * @brief 指定使用的指令集，超过CPU支持的级别时使用支持的最高级别
+ *
+ * @param isa
+ * @return SCAN_ISA 实际使用的指令集
+ */
+SCAN_ISA SetScanIsa(SCAN_ISA isa);
+/**
+ * @brief 查找[begin,end)中第一个\r\n
+ *
+ * @param begin
+ * @param end
+ * @return const char* 指向\r，没有时为空
+ */
+const char* FindCRLF(const char* begin, const char* end);
+/**
+ * @brief 查找[begin,end)中第一个属于set的字节
+ *
+ * @param begin
+ * @param end
+ * @param set 要查找的字节
+ * @param setLen set的长度，不超过16
+ * @return const char* 没有时为空
+ */
+const char* FindAny(const char* begin, const char* end, const char* set, size_t setLen);
+/**
+ * @brief 查找[begin,end)中第一个不是RFC 9110 token字符的字节，
+ * 用来在校验方法和头部名的同时找到后面的分隔符
+ *
+ * @param begin
+ * @param end
+ * @return const char* 全部是token字符时为空
+ */
+const char* FindNonToken(const char* begin, const char* end);
+/**
+ * @brief 查找[begin,end)中第一个控制字符(0x00-0x1f和0x7f)
+ *
+ * @param begin
+ * @param end
+ * @param allowTab 制表符不算控制字符
+ * @return const char* 没有时为空
+ */
+const char* FindCtl(const char* begin, const char* end, bool allowTab);
+/**
+ * @brief [begin,end)是否是非空的token
+ *
+ * @param begin
+ * @param end
+ * @return true
+ * @return false
+ */
+inline bool IsToken(const char* begin, const char* end){
+    return begin != end && !FindNonToken(begin, end);
+}
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file slab_pool.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "slab_pool.hpp"
+#include <cassert>
+#include <mutex>
+#include <new>
+namespace {
+/**
+ * @brief 全局的空闲块链表，只在本地池缺块或溢出时访问
+ *
+ */
+struct GlobalChunkList{
+    std::mutex mtx;
+    BufferChunk* head = nullptr;
+    size_t count = 0;
+};
+GlobalChunkList& Global(){
+    static GlobalChunkList* list = new GlobalChunkList();//不析构，保证线程退出时仍然可用
+    return *list;
+}
+}
+
+SlabPool& SlabPool::Local(){
+    thread_local SlabPool pool;
+    return pool;
+}
+
+BufferChunk* SlabPool::Allocate(){
+    if(!free_list_){
+        Refill_();
+    }
+    BufferChunk* chunk = free_list_;
+    free_list_ = chunk->next;
+    free_count_--;
+    chunk->next = nullptr;
+    chunk->capacity = CHUNK_DATA_SIZE;
+    chunk->read_pos = 0;
+    chunk->write_pos = 0;
+    return chunk;
+}
+
+BufferChunk* SlabPool::Allocate(size_t len){
+    if(len <= CHUNK_DATA_SIZE){
+        return Allocate();
+    }
+    //大块单独分配，释放时根据容量区分
+    void* mem = ::operator new(sizeof(BufferChunk) + len);
+    BufferChunk* chunk = static_cast<BufferChunk*>(mem);
+    chunk->next = nullptr;
+    chunk->capacity = len;
+    chunk->read_pos = 0;
+    chunk->write_pos = 0;
+    return chunk;
+}
+
+void SlabPool::Free(BufferChunk* chunk){
+    assert(chunk);
+    if(chunk->capacity != CHUNK_DATA_SIZE){
+        ::operator delete(chunk);
+        return;
+    }
+    chunk->next = free_list_;
+    free_list_ = chunk;
+    free_count_++;
+    if(free_count_ > LOCAL_CACHE_MAX){
+        Spill_(free_count_ / 2);
+    }
+}
+
+SlabPool::~SlabPool(){
+    Spill_(free_count_);//线程退出时全部归还到全局池
+}
+
+void SlabPool::Refill_(){
+    GlobalChunkList& global = Global();
+    {
+        std::lock_guard<std::mutex> locker(global.mtx);
+        //一次取回一个slab的量
+        while(global.head && free_count_ < CHUNKS_PER_SLAB){
+            BufferChunk* chunk = global.head;
+            global.head = chunk->next;
+            global.count--;
+            chunk->next = free_list_;
+            free_list_ = chunk;
+            free_count_++;
+        }
+    }
+    if(free_list_){
+        return;
+    }
+    NewSlab_();
+}
+
+void SlabPool::Reserve(size_t count){
+    while(free_count_ < count && free_count_ + CHUNKS_PER_SLAB <= LOCAL_CACHE_MAX){
+        NewSlab_();
+    }
+}
+
+void SlabPool::NewSlab_(){
+    char* slab = static_cast<char*>(::operator new(CHUNK_SIZE * CHUNKS_PER_SLAB));
+    for(size_t i = 0; i < CHUNKS_PER_SLAB; i++){
+        BufferChunk* chunk = reinterpret_cast<BufferChunk*>(slab + i * CHUNK_SIZE);
+        chunk->capacity = CHUNK_DATA_SIZE;
+        chunk->next = free_list_;
+        free_list_ = chunk;
+        free_count_++;
+    }
+}
+
+void SlabPool::Spill_(size_t count){
+    if(count == 0){
+        return;
+    }
+    //先在本地摘下一段链表，再一次性挂到全局链表上
+    BufferChunk* first = free_list_;
+    BufferChunk* last = first;
+    for(size_t i = 1; i < count; i++){
+        last = last->next;
+    }
+    free_list_ = last->next;
+    free_count_ -= count;
+    GlobalChunkList& global = Global();
+    std::lock_guard<std::mutex> locker(global.mtx);
+    last->next = global.head;
+    global.head = first;
+    global.count += count;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file slab_pool.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 线程本地的定长块内存池
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _SLAB_POOL_HPP_
+#define _SLAB_POOL_HPP_
+#include <cstddef>
+/**
+ * @brief 分段缓冲使用的数据块，头部之后紧跟数据区
+ *
+ */
+struct BufferChunk{
+    BufferChunk* next;//链表中的下一个块
+    size_t capacity;//数据区容量
+    size_t read_pos;//读取位置
+    size_t write_pos;//写入位置
+    char* Data(){
+        return reinterpret_cast<char*>(this + 1);
+    }
+    const char* Data() const{
+        return reinterpret_cast<const char*>(this + 1);
+    }
+    size_t ReadableBytes() const{
+        return write_pos - read_pos;
+    }
+    size_t WriteableBytes() const{
+        return capacity - write_pos;
+    }
+};
+/**
+ * @brief 定长块的slab内存池
+ * 每个线程持有一个本地池，块的申请和归还不加锁；
+ * 本地空闲块过多或者线程退出时成批归还到全局池，slab本身不归还给系统
+ */
+class SlabPool{
+    public:
+        static constexpr size_t CHUNK_SIZE = 4096;//每个块占用的总字节数
+        static constexpr size_t CHUNK_DATA_SIZE = CHUNK_SIZE - sizeof(BufferChunk);//每个块的数据区容量
+        static constexpr size_t CHUNKS_PER_SLAB = 64;//每次向系统申请的块数
+        static constexpr size_t LOCAL_CACHE_MAX = 256;//本地最多缓存的空闲块数
+        /**
+         * @brief 获取当前线程的内存池
+         *
+         * @return SlabPool&
+         */
+        static SlabPool& Local();
+        /**
+         * @brief 申请一个定长块
+         *
+         * @return BufferChunk*
+         */
+        BufferChunk* Allocate();
+        /**
+         * @brief 申请一个数据区至少为len的块，超过定长块容量时单独分配
+         *
+         * @param len
+         * @return BufferChunk*
+         */
+        BufferChunk* Allocate(size_t len);
+        /**
+         * @brief 归还块
+         *
+         * @param chunk
+         */
+        void Free(BufferChunk* chunk);
+        /**
+         * @brief 由当前线程直接向系统申请slab，使本地至少有count个空闲块；
+         * 新的页面由当前线程首次写入，会分配在当前线程所在的NUMA节点上。
+         * 预留量不超过LOCAL_CACHE_MAX，否则第一次Free就会把预留的块溢出到全局池
+         *
+         * @param count
+         */
+        void Reserve(size_t count);
+        /**
+         * @brief 本地空闲块数
+         *
+         * @return size_t
+         */
+        size_t FreeCount() const{
+            return free_count_;
+        }
+        ~SlabPool();
+    private:
+        SlabPool() = default;
+        SlabPool(const SlabPool&) = delete;
+        SlabPool& operator=(const SlabPool&) = delete;
+        /**
+         * @brief 从全局池取回一批空闲块，全局池为空时申请新的slab
+         *
+         */
+        void Refill_();
+        /**
+         * @brief 向系统申请一个新的slab放进本地空闲链表
+         *
+         */
+        void NewSlab_();
+        /**
+         * @brief 把count个本地空闲块归还到全局池
+         *
+         */
+        void Spill_(size_t count);
+        BufferChunk* free_list_ = nullptr;//本地空闲链表
+        size_t free_count_ = 0;//本地空闲块数
+};
+#endif
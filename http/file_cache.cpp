@@ -0,0 +1,204 @@
+/**
+ * @file file_cache.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "file_cache.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+CachedFile::~CachedFile(){
+    if(mapped){
+        munmap(const_cast<char*>(data), size);
+    }else{
+        delete[] data;
+    }
+}
+
+FileCache* FileCache::Instance(){
+    static FileCache cache;
+    return &cache;
+}
+
+void FileCache::Init(size_t byteBudget, int checkInterval, size_t shardCount){
+    assert(shardCount > 0);
+    shards_.clear();
+    for(size_t i = 0; i < shardCount; i++){
+        shards_.emplace_back(new Shard());
+    }
+    shard_budget_ = byteBudget / shardCount;
+    check_interval_ = checkInterval;
+}
+
+std::shared_ptr<const CachedFile> FileCache::Get(const std::string& path){
+    Shard& shard = ShardOf_(path);
+    std::shared_ptr<CachedFile> file;
+    {
+        std::lock_guard<std::mutex> locker(shard.mtx);
+        auto it = shard.index.find(path);
+        if(it != shard.index.end()){
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);//移到最前面
+            file = *it->second;
+        }
+    }
+    if(file){
+        if(Fresh_(*file)){
+            shard.hits.fetch_add(1, std::memory_order_relaxed);
+            return file;
+        }
+        shard.invalidations.fetch_add(1, std::memory_order_relaxed);
+        Remove_(shard, path, file.get());
+    }
+    shard.misses.fetch_add(1, std::memory_order_relaxed);
+    file = Load_(path);//在锁外读盘
+    if(!file){
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    auto it = shard.index.find(path);
+    if(it != shard.index.end()){//其他线程已经加载过了
+        return *it->second;
+    }
+    shard.lru.push_front(file);
+    shard.index[path] = shard.lru.begin();
+    shard.bytes += file->size;
+    Evict_(shard);
+    return file;
+}
+
+void FileCache::Invalidate(const std::string& path){
+    Remove_(ShardOf_(path), path, nullptr);
+}
+
+void FileCache::Remove_(Shard& shard, const std::string& path, const CachedFile* expected){
+    std::lock_guard<std::mutex> locker(shard.mtx);
+    auto it = shard.index.find(path);
+    if(it == shard.index.end() || (expected && it->second->get() != expected)){
+        return;
+    }
+    shard.bytes -= (*it->second)->size;
+    shard.lru.erase(it->second);//已经发出的文件由shared_ptr保持到发送完毕
+    shard.index.erase(it);
+}
+
+void FileCache::Clear(){
+    for(auto& shard : shards_){
+        std::lock_guard<std::mutex> locker(shard->mtx);
+        shard->lru.clear();
+        shard->index.clear();
+        shard->bytes = 0;
+    }
+}
+
+FileCacheStats FileCache::Stats(){
+    FileCacheStats stats;
+    for(auto& shard : shards_){
+        stats.hits += shard->hits.load(std::memory_order_relaxed);
+        stats.misses += shard->misses.load(std::memory_order_relaxed);
+        stats.evictions += shard->evictions.load(std::memory_order_relaxed);
+        stats.invalidations += shard->invalidations.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> locker(shard->mtx);
+        stats.bytes += shard->bytes;
+        stats.files += shard->index.size();
+    }
+    return stats;
+}
+
+FileCache::Shard& FileCache::ShardOf_(const std::string& path){
+    return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+std::shared_ptr<CachedFile> FileCache::Load_(const std::string& path){
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return nullptr;
+    }
+    struct stat st;
+    if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) > shard_budget_){
+        close(fd);
+        return nullptr;
+    }
+    std::shared_ptr<CachedFile> file(new CachedFile());
+    file->path = path;
+    file->size = st.st_size;
+    file->mtime = st.st_mtime;
+    file->ino = st.st_ino;
+    if(file->size >= SMALL_FILE_LIMIT){//大文件映射
+        void* addr = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(addr == MAP_FAILED){
+            close(fd);
+            return nullptr;
+        }
+        file->data = static_cast<const char*>(addr);
+        file->mapped = true;
+    }else if(file->size > 0){//小文件直接拷贝，避免占用大量映射
+        char* data = new char[file->size];
+        size_t done = 0;
+        while(done < file->size){
+            ssize_t n = pread(fd, data + done, file->size - done, done);
+            if(n <= 0){
+                delete[] data;
+                close(fd);
+                return nullptr;
+            }
+            done += n;
+        }
+        file->data = data;
+    }
+    close(fd);
+    //预先生成响应头，发送时不需要再格式化
+    char etag[64];
+    snprintf(etag, sizeof(etag), "\"%lx-%lx-%lx\"",
+             static_cast<unsigned long>(file->ino),
+             static_cast<unsigned long>(file->size),
+             static_cast<unsigned long>(file->mtime));
+    file->etag = etag;
+    char modified[64];
+    struct tm t;
+    gmtime_r(&file->mtime, &t);
+    strftime(modified, sizeof(modified), "%a, %d %b %Y %H:%M:%S GMT", &t);
+    file->header = "Content-Length: " + std::to_string(file->size) + "\r\n"
+                 + "ETag: " + file->etag + "\r\n"
+                 + "Last-Modified: " + modified + "\r\n";
+    file->checked.store(time(nullptr), std::memory_order_relaxed);
+    return file;
+}
+
+bool FileCache::Fresh_(const CachedFile& file){
+    time_t now = time(nullptr);
+    time_t checked = file.checked.load(std::memory_order_relaxed);
+    if(check_interval_ > 0 && now - checked < check_interval_){
+        return true;
+    }
+    struct stat st;
+    if(stat(file.path.c_str(), &st) < 0){
+        return false;
+    }
+    if(st.st_mtime != file.mtime || st.st_ino != file.ino
+       || static_cast<size_t>(st.st_size) != file.size){
+        return false;
+    }
+    file.checked.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+void FileCache::Evict_(Shard& shard){
+    while(shard.bytes > shard_budget_ && shard.lru.size() > 1){//从最久没用的开始淘汰
+        auto& victim = shard.lru.back();
+        shard.bytes -= victim->size;
+        shard.index.erase(victim->path);
+        shard.lru.pop_back();
+        shard.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,152 @@
+/**
+ * @file file_cache.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 热点静态文件缓存
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _FILE_CACHE_HPP_
+#define _FILE_CACHE_HPP_
+#include <atomic>
+#include <cstddef>
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <vector>
+/**
+ * @brief 缓存中的一个文件
+ * 小文件拷贝到内存，大文件保持映射，同时保存预先生成的响应头
+ */
+struct CachedFile{
+    std::string path;//文件路径
+    const char* data = nullptr;//文件内容
+    size_t size = 0;//文件大小
+    time_t mtime = 0;//修改时间
+    ino_t ino = 0;//inode编号
+    bool mapped = false;//内容是否是映射的
+    std::string header;//Content-Length、ETag和Last-Modified响应头，每行以\r\n结尾
+    std::string etag;//ETag的值，带引号
+    mutable std::atomic<time_t> checked;//上次检查修改时间的时间
+    CachedFile() : checked(0){}
+    ~CachedFile();
+    CachedFile(const CachedFile&) = delete;
+    CachedFile& operator=(const CachedFile&) = delete;
+};
+/**
+ * @brief 缓存的统计
+ *
+ */
+struct FileCacheStats{
+    size_t hits = 0;//命中次数
+    size_t misses = 0;//未命中次数
+    size_t evictions = 0;//淘汰次数
+    size_t invalidations = 0;//文件修改导致失效的次数
+    size_t bytes = 0;//当前缓存的字节数
+    size_t files = 0;//当前缓存的文件数
+};
+/**
+ * @brief 进程共享的静态文件缓存
+ * 按路径哈希分片加锁，每个分片独立做LRU淘汰，所有分片共享字节预算；
+ * 命中时每隔一段时间检查一次文件的修改时间，文件变化就重新加载
+ */
+class FileCache{
+    public:
+        static FileCache* Instance();
+        /**
+         * @brief 初始化缓存，会清空已有内容，只能在工作线程启动前调用
+         *
+         * @param byteBudget 缓存的总字节数上限
+         * @param checkInterval 检查文件修改时间的间隔，单位秒，0表示每次都检查
+         * @param shardCount 分片数
+         */
+        void Init(size_t byteBudget = 64 << 20, int checkInterval = 2, size_t shardCount = 16);
+        /**
+         * @brief 获取文件，不在缓存中就加载
+         *
+         * @param path
+         * @return std::shared_ptr<const CachedFile> 文件不存在、不是普通文件或者超过分片预算时返回空
+         */
+        std::shared_ptr<const CachedFile> Get(const std::string& path);
+        /**
+         * @brief 使指定文件失效
+         *
+         * @param path
+         */
+        void Invalidate(const std::string& path);
+        /**
+         * @brief 清空缓存
+         *
+         */
+        void Clear();
+        /**
+         * @brief 获取统计
+         *
+         * @return FileCacheStats
+         */
+        FileCacheStats Stats();
+    private:
+        static constexpr size_t SMALL_FILE_LIMIT = 16384;//小于这个大小的文件拷贝到内存，否则映射
+        typedef std::list<std::shared_ptr<CachedFile>> LruList;
+        /**
+         * @brief 一个分片
+         *
+         */
+        struct Shard{
+            std::mutex mtx;
+            LruList lru;//最近使用的在前面
+            std::unordered_map<std::string, LruList::iterator> index;
+            size_t bytes = 0;
+            std::atomic<size_t> hits{0};
+            std::atomic<size_t> misses{0};
+            std::atomic<size_t> evictions{0};
+            std::atomic<size_t> invalidations{0};
+        };
+        FileCache(){
+            Init();
+        }
+        ~FileCache() = default;
+        FileCache(const FileCache&) = delete;
+        FileCache& operator=(const FileCache&) = delete;
+        Shard& ShardOf_(const std::string& path);
+        /**
+         * @brief 从磁盘加载文件
+         *
+         * @param path
+         * @return std::shared_ptr<CachedFile>
+         */
+        std::shared_ptr<CachedFile> Load_(const std::string& path);
+        /**
+         * @brief 检查文件是否在加载之后被修改
+         *
+         * @param file
+         * @return true 文件没有变化
+         * @return false 文件已经变化或者被删除
+         */
+        bool Fresh_(const CachedFile& file);
+        /**
+         * @brief 在分片锁内删除文件
+         *
+         * @param shard
+         * @param path
+         * @param expected 非空时只有缓存的仍然是这个对象才删除，避免删掉其他线程刚加载的新版本
+         */
+        void Remove_(Shard& shard, const std::string& path, const CachedFile* expected);
+        /**
+         * @brief 在持有分片锁时淘汰到预算以内
+         *
+         * @param shard
+         */
+        void Evict_(Shard& shard);
+        std::vector<std::unique_ptr<Shard>> shards_;
+        size_t shard_budget_ = 0;//每个分片的字节预算
+        int check_interval_ = 2;
+};
+#endif
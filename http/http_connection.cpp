@@ -0,0 +1,222 @@
+/**
+ * @file http_connection.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "http_connection.hpp"
+#include "http_response.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <string_view>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <utility>
+std::string HttpConnection::srcDir_ = "./resources/";
+HttpConnection::HttpConnection(Reactor* loop, int fd, const sockaddr_in& addr)
+    :Connection(loop, fd, addr),headerEnd_(0),keepAlive_(true),peerClosed_(false),readPaused_(false),requestCount_(0){
+}
+void HttpConnection::SetSrcDir(const std::string& dir){
+    srcDir_ = dir;
+    if(srcDir_.empty() || srcDir_.back() != '/'){
+        srcDir_.push_back('/');
+    }
+}
+bool HttpConnection::Read_(bool edge){
+    int err = 0;
+    readPaused_ = false;
+    do{
+        if(!pending_.empty() && readBuff_.ReadableBytes() >= MAX_READ_BACKLOG){
+            readPaused_ = true;//对端不读取响应时不再继续接收，写完之后再读
+            break;
+        }
+        ssize_t len = readBuff_.ReadFd(fd_, &err);
+        if(len == 0){
+            peerClosed_ = true;
+            break;
+        }
+        if(len < 0){
+            return err == EAGAIN || err == EWOULDBLOCK;
+        }
+    }while(edge);
+    return true;
+}
+bool HttpConnection::OnRead(bool edge){
+    if(!Read_(edge)){
+        return false;
+    }
+    Process_();//对端只是关闭了发送方向时，已经收到的请求仍然要应答
+    return true;
+}
+void HttpConnection::Process_(){
+    while(keepAlive_ && pending_.size() < MAX_PIPELINE){
+        HttpRequest::PARSE_RESULT result = request_.Parse(readBuff_);
+        if(result == HttpRequest::PARSE_AGAIN){
+            break;
+        }
+        requestCount_++;
+        if(result == HttpRequest::PARSE_ERROR){//出错之后不再解析，应答之后关闭
+            keepAlive_ = false;
+            RenderError_(request_.ErrorCode());
+            readBuff_.RetrieveAll();
+            request_.Init();
+            break;
+        }
+        keepAlive_ = request_.IsKeepAlive();
+        Render_(request_);
+        readBuff_.Retrieve(request_.Length());
+        request_.Init();
+    }
+}
+void HttpConnection::Render_(const HttpRequest& request){
+    std::string_view method = request.Method();
+    bool head = method == "HEAD";
+    if(method != "GET" && !head){
+        RenderError_(405);
+        return;
+    }
+    std::string_view path = request.Path();
+    if(path.empty() || path[0] != '/' || path.find("/..") != std::string_view::npos){
+        RenderError_(403);
+        return;
+    }
+    thread_local std::string file;//复用路径的存储
+    file.assign(srcDir_).append(path.data() + 1, path.size() - 1);
+    if(path.back() == '/'){
+        file.append("index.html");
+    }
+    Response pending;
+    HttpResponse response(writeBuff_);
+    std::shared_ptr<const CachedFile> cached = FileCache::Instance()->Get(file);
+    if(cached){
+        std::string_view etag = request.GetHeader("If-None-Match");
+        bool notModified = !etag.empty() && etag == cached->etag;
+        response.Head(notModified ? 304 : 200, keepAlive_).Lines(cached->header).ContentType(file).End();
+        if(!notModified && !head && cached->size > 0){
+            pending.body = cached->data;
+            pending.bodyLen = cached->size;
+            pending.file = std::move(cached);
+        }
+    }else{
+        std::unique_ptr<StaticFile> large(new StaticFile());
+        if(!large->Open(file)){
+            RenderError_(404);
+            return;
+        }
+        response.Head(200, keepAlive_).ContentLength(large->Size()).ContentType(file).End();
+        if(!head && large->Size() > 0){
+            pending.large = std::move(large);
+        }
+    }
+    Push_(std::move(pending));
+}
+void HttpConnection::RenderError_(int code){
+    static constexpr std::string_view PREFIX = "<html><title>Error</title><body><h1>";
+    static constexpr std::string_view SUFFIX = "</h1></body></html>";
+    std::string_view text = HttpResponse::StatusText(code);
+    HttpResponse response(writeBuff_);
+    response.Head(code, keepAlive_).ContentLength(PREFIX.size() + text.size() + SUFFIX.size()).ContentType(".html");
+    if(code == 405){
+        response.Header("Allow", "GET, HEAD");
+    }
+    response.End();
+    writeBuff_.Append(PREFIX.data(), PREFIX.size());
+    writeBuff_.Append(text.data(), text.size());
+    writeBuff_.Append(SUFFIX.data(), SUFFIX.size());
+    Push_(Response());
+}
+void HttpConnection::Push_(Response response){
+    response.header = writeBuff_.ReadableBytes() - headerEnd_;
+    headerEnd_ = writeBuff_.ReadableBytes();
+    pending_.push_back(std::move(response));
+}
+void HttpConnection::Consume_(size_t len){
+    while(len > 0 && !pending_.empty()){
+        Response& response = pending_.front();
+        size_t n = std::min(len, response.header);
+        writeBuff_.Retrieve(n);
+        response.header -= n;
+        headerEnd_ -= n;
+        len -= n;
+        n = std::min(len, response.bodyLen);
+        response.body += n;
+        response.bodyLen -= n;
+        len -= n;
+        if(response.header > 0 || response.bodyLen > 0 || response.large){
+            break;
+        }
+        pending_.pop_front();
+    }
+}
+bool HttpConnection::OnWrite(){
+    int err = 0;
+    while(!pending_.empty()){
+        Response& front = pending_.front();
+        if(front.header == 0 && front.large){//响应头已经写出，文件内容由内核直接发送
+            static thread_local Buffer none(0);
+            if(front.large->SendTo(fd_, none, &err) < 0){
+                return err == EAGAIN || err == EWOULDBLOCK;
+            }
+            pending_.pop_front();
+            continue;
+        }
+        //把所有响应头和缓存的消息体收集起来一次写出，遇到大文件就停在它的响应头之后
+        struct iovec chunks[MAX_IOV];
+        const int chunkCount = writeBuff_.GetReadIovec(chunks, MAX_IOV);
+        struct iovec iov[MAX_IOV];
+        int count = 0;
+        int chunk = 0;
+        size_t offset = 0;//响应头在当前块中的起点
+        for(const Response& response : pending_){
+            size_t header = response.header;
+            while(header > 0 && chunk < chunkCount){//响应头可能跨块
+                char* base = static_cast<char*>(chunks[chunk].iov_base) + offset;
+                size_t n = std::min(header, chunks[chunk].iov_len - offset);
+                if(count > 0 && static_cast<char*>(iov[count - 1].iov_base) + iov[count - 1].iov_len == base){
+                    iov[count - 1].iov_len += n;//没有消息体的相邻响应头合并成一段
+                }else if(count < MAX_IOV){
+                    iov[count].iov_base = base;
+                    iov[count].iov_len = n;
+                    count++;
+                }else{
+                    break;
+                }
+                header -= n;
+                offset += n;
+                if(offset == chunks[chunk].iov_len){
+                    chunk++;
+                    offset = 0;
+                }
+            }
+            if(header > 0 || response.large || count == MAX_IOV){//响应头没有收集完整时不能接着写消息体
+                break;
+            }
+            if(response.bodyLen > 0){
+                iov[count].iov_base = const_cast<char*>(response.body);
+                iov[count].iov_len = response.bodyLen;
+                count++;
+            }
+        }
+        ssize_t len = writev(fd_, iov, count);
+        if(len < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        Consume_(static_cast<size_t>(len));
+        if(pending_.empty()){//积压的请求在响应写完之后继续处理
+            if(readPaused_ && !Read_(true)){
+                return false;
+            }
+            if(readBuff_.ReadableBytes() > 0){
+                Process_();
+            }
+        }
+    }
+    return true;
+}
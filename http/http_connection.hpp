@@ -0,0 +1,124 @@
+/**
+ * @file http_connection.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 支持长连接和流水线的HTTP连接
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _HTTP_CONNECTION_HPP_
+#define _HTTP_CONNECTION_HPP_
+#include "../buffer/buffer.hpp"
+#include "../buffer/chain_buffer.hpp"
+#include "../main/connection.hpp"
+#include "file_cache.hpp"
+#include "http_request.hpp"
+#include "static_file.hpp"
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+/**
+ * @brief HTTP连接
+ * 一个连接上依次处理多个请求：读缓冲里所有完整的请求一次解析完，响应头连续写入写缓冲，
+ * 消息体直接引用文件缓存里的数据，然后用一次writev把所有响应头和消息体一起写出。
+ * 读缓冲是连续的Buffer，解析器直接在上面工作，只在尾部放不下时搬移剩下的半个请求；
+ * 写缓冲是ChainBuffer，流水线的响应头追加时不搬移已有数据，块来自线程本地的SlabPool
+ * 空闲超时由事件循环在每次读写事件时刷新
+ */
+class HttpConnection : public Connection{
+    public:
+        static constexpr size_t MAX_PIPELINE = 64;//未写完的响应超过这个数就暂停解析
+        static constexpr size_t MAX_READ_BACKLOG = 1 << 20;//有未写完的响应时读缓冲的上限
+        static constexpr int MAX_IOV = 64;//一次writev最多的数据段
+        HttpConnection(Reactor* loop, int fd, const sockaddr_in& addr);
+        ~HttpConnection() override = default;
+        /**
+         * @brief 设置静态文件的根目录，在事件循环启动前调用
+         *
+         * @param dir
+         */
+        static void SetSrcDir(const std::string& dir);
+        static const std::string& SrcDir(){
+            return srcDir_;
+        }
+        bool OnRead(bool edge) override;
+        bool OnWrite() override;
+        bool WantWrite() const override{
+            return !pending_.empty();
+        }
+        bool KeepAlive() const override{
+            return keepAlive_ && !peerClosed_;
+        }
+        /**
+         * @brief 这个连接上已经处理的请求数
+         *
+         * @return size_t
+         */
+        size_t RequestCount() const{
+            return requestCount_;
+        }
+    private:
+        /**
+         * @brief 一个待发送的响应
+         * 响应头按顺序存放在写缓冲里，可能跨块，这里只记录还没写出的长度
+         */
+        struct Response{
+            size_t header = 0;//写缓冲中还没写出的响应头字节数
+            std::shared_ptr<const CachedFile> file;//缓存的消息体，写完之前保持有效
+            const char* body = nullptr;//消息体剩余部分的起点
+            size_t bodyLen = 0;//消息体剩余的字节数
+            std::unique_ptr<StaticFile> large;//不能缓存的大文件，用sendfile发送
+        };
+        /**
+         * @brief 读取socket中的数据
+         *
+         * @param edge 是否读到EAGAIN为止
+         * @return true
+         * @return false 对端出错
+         */
+        bool Read_(bool edge);
+        /**
+         * @brief 解析读缓冲中所有完整的请求并生成响应
+         *
+         */
+        void Process_();
+        /**
+         * @brief 为一个请求生成响应
+         *
+         * @param request
+         */
+        void Render_(const HttpRequest& request);
+        /**
+         * @brief 生成错误响应，消息体是简短的HTML
+         *
+         * @param code
+         */
+        void RenderError_(int code);
+        /**
+         * @brief 把已经写入写缓冲的响应头加入队列
+         *
+         * @param response
+         */
+        void Push_(Response response);
+        /**
+         * @brief 写出的字节依次从队列头部的响应中扣除
+         *
+         * @param len
+         */
+        void Consume_(size_t len);
+        static std::string srcDir_;//静态文件根目录，以/结尾
+        Buffer readBuff_;
+        ChainBuffer writeBuff_;
+        HttpRequest request_;
+        std::deque<Response> pending_;//还没写完的响应
+        size_t headerEnd_;//写缓冲中已经加入队列的响应头末尾，相对Peek()
+        bool keepAlive_;
+        bool peerClosed_;//对端已经不再发送
+        bool readPaused_;//因为响应积压暂停了读取
+        size_t requestCount_;
+};
+#endif
@@ -0,0 +1,240 @@
+#include "http_request.hpp"
+#include "../buffer/scan.hpp"
+#include <cstring>
+#include <strings.h>
+namespace {
+inline bool EqualsNoCase(std::string_view a, std::string_view b){
+    return a.size() == b.size() && strncasecmp(a.data(), b.data(), a.size()) == 0;
+}
+inline bool IsSpace(char c){
+    return c == ' ' || c == '\t';
+}
+}
+void HttpRequest::Init(){
+    base_ = nullptr;
+    state_ = REQUEST_LINE;
+    error_ = 0;
+    pos_ = 0;
+    lineStart_ = 0;
+    bodyStart_ = 0;
+    contentLength_ = 0;
+    method_ = path_ = query_ = version_ = Span{0, 0};
+    headerCount_ = 0;
+    http11_ = false;
+    hasContentLength_ = false;
+    chunked_ = false;
+    connClose_ = false;
+    connKeepAlive_ = false;
+    keepAlive_ = false;
+}
+HttpRequest::PARSE_RESULT HttpRequest::Parse(const char* data, size_t len){
+    base_ = data;
+    if(state_ == FINISH){
+        return PARSE_OK;
+    }
+    if(state_ == INVALID){
+        return PARSE_ERROR;
+    }
+    while(state_ == REQUEST_LINE || state_ == HEADERS){
+        const char* crlf = FindCRLF(data + pos_, data + len);
+        if(!crlf){//行不完整，记住扫描到的位置，末尾的\r留到下次和\n一起匹配
+            pos_ = len > pos_ && data[len - 1] == '\r' ? len - 1 : len;
+            if(state_ == REQUEST_LINE && pos_ - lineStart_ > MAX_REQUEST_LINE){
+                return Fail_(414);
+            }
+            if(pos_ > MAX_HEADER_BYTES){
+                return Fail_(431);
+            }
+            return PARSE_AGAIN;
+        }
+        size_t begin = lineStart_;
+        size_t end = static_cast<size_t>(crlf - data);
+        pos_ = lineStart_ = end + 2;
+        if(pos_ > MAX_HEADER_BYTES){
+            return Fail_(state_ == REQUEST_LINE ? 400 : 431);
+        }
+        if(state_ == REQUEST_LINE){
+            if(end - begin > MAX_REQUEST_LINE){
+                return Fail_(414);
+            }
+            if(!ParseRequestLine_(begin, end)){
+                return PARSE_ERROR;
+            }
+        }else{
+            if(!ParseHeader_(begin, end)){
+                return PARSE_ERROR;
+            }
+        }
+    }
+    if(len - bodyStart_ < contentLength_){
+        return PARSE_AGAIN;
+    }
+    state_ = FINISH;
+    return PARSE_OK;
+}
+bool HttpRequest::ParseRequestLine_(size_t begin, size_t end){
+    if(begin == end){//请求之前的空行忽略
+        return true;
+    }
+    const char* line = base_ + begin;
+    size_t len = end - begin;
+    const char* sp1 = FindNonToken(line, line + len);//方法之后的第一个字节必须是空格
+    if(!sp1 || sp1 == line || *sp1 != ' '){
+        Fail_(400);
+        return false;
+    }
+    const char* target = sp1 + 1;
+    const char* sp2 = static_cast<const char*>(memchr(target, ' ', line + len - target));
+    if(!sp2){
+        Fail_(400);
+        return false;
+    }
+    size_t methodLen = sp1 - line;
+    size_t targetLen = sp2 - target;
+    size_t versionLen = line + len - (sp2 + 1);
+    if(targetLen == 0 || FindCtl(target, sp2, false)){
+        Fail_(400);
+        return false;
+    }
+    std::string_view version(sp2 + 1, versionLen);
+    if(version == "HTTP/1.1"){
+        http11_ = true;
+    }else if(version == "HTTP/1.0"){
+        http11_ = false;
+    }else{
+        Fail_(version.size() == 8 && version.compare(0, 5, "HTTP/") == 0 ? 505 : 400);
+        return false;
+    }
+    method_ = Span{static_cast<uint32_t>(begin), static_cast<uint32_t>(methodLen)};
+    uint32_t targetOff = static_cast<uint32_t>(target - base_);
+    const char* question = static_cast<const char*>(memchr(target, '?', targetLen));
+    if(question){
+        uint32_t pathLen = static_cast<uint32_t>(question - target);
+        path_ = Span{targetOff, pathLen};
+        query_ = Span{targetOff + pathLen + 1, static_cast<uint32_t>(targetLen) - pathLen - 1};
+    }else{
+        path_ = Span{targetOff, static_cast<uint32_t>(targetLen)};
+    }
+    version_ = Span{static_cast<uint32_t>(sp2 + 1 - base_), static_cast<uint32_t>(versionLen)};
+    state_ = HEADERS;
+    return true;
+}
+bool HttpRequest::ParseHeader_(size_t begin, size_t end){
+    if(begin == end){
+        return FinishHeaders_();
+    }
+    const char* line = base_ + begin;
+    size_t len = end - begin;
+    if(IsSpace(line[0])){//不支持续行
+        Fail_(400);
+        return false;
+    }
+    const char* colon = FindNonToken(line, line + len);//头部名之后的第一个字节必须是冒号
+    if(!colon || colon == line || *colon != ':'){
+        Fail_(400);
+        return false;
+    }
+    const char* value = colon + 1;
+    const char* valueEnd = line + len;
+    while(value < valueEnd && IsSpace(*value)){
+        value++;
+    }
+    while(valueEnd > value && IsSpace(valueEnd[-1])){
+        valueEnd--;
+    }
+    if(FindCtl(value, valueEnd, true)){
+        Fail_(400);
+        return false;
+    }
+    if(headerCount_ == MAX_HEADERS){
+        Fail_(431);
+        return false;
+    }
+    Header& header = headers_[headerCount_++];
+    header.name = Span{static_cast<uint32_t>(begin), static_cast<uint32_t>(colon - line)};
+    header.value = Span{static_cast<uint32_t>(value - base_), static_cast<uint32_t>(valueEnd - value)};
+    //影响消息边界和连接的头部在这里就处理掉，之后不必再查找
+    std::string_view name = View_(header.name);
+    std::string_view val = View_(header.value);
+    if(EqualsNoCase(name, "Content-Length")){
+        if(val.empty() || val.size() > 18){
+            Fail_(400);
+            return false;
+        }
+        size_t length = 0;
+        for(char c : val){
+            if(c < '0' || c > '9'){
+                Fail_(400);
+                return false;
+            }
+            length = length * 10 + (c - '0');
+        }
+        if(hasContentLength_ && length != contentLength_){//长度不一致可能是请求走私
+            Fail_(400);
+            return false;
+        }
+        hasContentLength_ = true;
+        contentLength_ = length;
+    }else if(EqualsNoCase(name, "Transfer-Encoding")){
+        if(!EqualsNoCase(val, "identity")){
+            chunked_ = true;
+        }
+    }else if(EqualsNoCase(name, "Connection")){
+        size_t pos = 0;
+        while(pos < val.size()){
+            size_t comma = val.find(',', pos);
+            if(comma == std::string_view::npos){
+                comma = val.size();
+            }
+            std::string_view option = val.substr(pos, comma - pos);
+            while(!option.empty() && IsSpace(option.front())){
+                option.remove_prefix(1);
+            }
+            while(!option.empty() && IsSpace(option.back())){
+                option.remove_suffix(1);
+            }
+            if(EqualsNoCase(option, "close")){
+                connClose_ = true;
+            }else if(EqualsNoCase(option, "keep-alive")){
+                connKeepAlive_ = true;
+            }
+            pos = comma + 1;
+        }
+    }
+    return true;
+}
+bool HttpRequest::FinishHeaders_(){
+    if(chunked_){//消息体不连续就不能零拷贝表示
+        Fail_(hasContentLength_ ? 400 : 501);
+        return false;
+    }
+    if(contentLength_ > MAX_BODY){
+        Fail_(413);
+        return false;
+    }
+    keepAlive_ = http11_ ? !connClose_ : (connKeepAlive_ && !connClose_);
+    bodyStart_ = pos_;
+    state_ = BODY;
+    return true;
+}
+HttpRequest::PARSE_RESULT HttpRequest::Fail_(int code){
+    error_ = code;
+    state_ = INVALID;
+    return PARSE_ERROR;
+}
+std::string_view HttpRequest::GetHeader(std::string_view name) const{
+    for(size_t i = 0; i < headerCount_; i++){
+        if(EqualsNoCase(View_(headers_[i].name), name)){
+            return View_(headers_[i].value);
+        }
+    }
+    return std::string_view();
+}
+bool HttpRequest::HasHeader(std::string_view name) const{
+    for(size_t i = 0; i < headerCount_; i++){
+        if(EqualsNoCase(View_(headers_[i].name), name)){
+            return true;
+        }
+    }
+    return false;
+}
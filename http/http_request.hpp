@@ -0,0 +1,197 @@
+/**
+ * @file http_request.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 增量解析的HTTP/1.1请求
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _HTTP_REQUEST_HPP_
+#define _HTTP_REQUEST_HPP_
+#include "../buffer/buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+/**
+ * @brief HTTP请求
+ * 直接在读缓冲上解析，数据不完整时记住解析到的位置，下次从新到达的数据继续，已经扫描过的字节不会再扫描；
+ * 请求行、头部和消息体都以相对请求起点的偏移保存，访问时才生成指向缓冲的string_view，
+ * 所以两次读取之间缓冲搬移或者扩容都不影响解析。头部存放在固定大小的内联数组中，解析过程不分配内存
+ */
+class HttpRequest{
+    public:
+        /**
+         * @brief 解析的阶段
+         *
+         */
+        enum PARSE_STATE{
+            REQUEST_LINE = 0,
+            HEADERS,
+            BODY,
+            FINISH,
+            INVALID
+        };
+        /**
+         * @brief 一次解析的结果
+         *
+         */
+        enum PARSE_RESULT{
+            PARSE_AGAIN = 0,//数据不完整，等待更多数据
+            PARSE_OK,//得到一个完整的请求
+            PARSE_ERROR//请求格式错误，ErrorCode给出应答的状态码
+        };
+        static constexpr size_t MAX_HEADERS = 64;//头部的最大个数
+        static constexpr size_t MAX_REQUEST_LINE = 8192;//请求行的最大长度
+        static constexpr size_t MAX_HEADER_BYTES = 65536;//请求行和头部的最大总长度
+        static constexpr size_t MAX_BODY = 8 << 20;//消息体的最大长度
+        HttpRequest(){
+            Init();
+        }
+        /**
+         * @brief 重置状态，准备解析下一个请求
+         *
+         */
+        void Init();
+        /**
+         * @brief 解析请求，data必须从请求的第一个字节开始，并且包含之前调用时传入的全部数据
+         *
+         * @param data 请求的起点，一般是读缓冲的Peek()
+         * @param len 可读的字节数
+         * @return PARSE_RESULT
+         */
+        PARSE_RESULT Parse(const char* data, size_t len);
+        PARSE_RESULT Parse(const Buffer& buff){
+            return Parse(buff.Peek(), buff.ReadableBytes());
+        }
+        PARSE_STATE State() const{
+            return state_;
+        }
+        /**
+         * @brief 解析失败时应答的状态码，没有错误时为0
+         *
+         * @return int
+         */
+        int ErrorCode() const{
+            return error_;
+        }
+        /**
+         * @brief 完整请求占用的字节数，解析成功后从读缓冲读取这么多字节
+         *
+         * @return size_t
+         */
+        size_t Length() const{
+            return state_ == FINISH ? bodyStart_ + contentLength_ : 0;
+        }
+        //以下访问函数返回的string_view指向最近一次Parse传入的数据，缓冲被修改之前有效
+        std::string_view Method() const{
+            return View_(method_);
+        }
+        /**
+         * @brief 请求目标中问号之前的部分
+         *
+         * @return std::string_view
+         */
+        std::string_view Path() const{
+            return View_(path_);
+        }
+        /**
+         * @brief 请求目标中问号之后的部分，不包含问号
+         *
+         * @return std::string_view
+         */
+        std::string_view Query() const{
+            return View_(query_);
+        }
+        std::string_view Version() const{
+            return View_(version_);
+        }
+        std::string_view Body() const{
+            return state_ == FINISH ? std::string_view(base_ + bodyStart_, contentLength_) : std::string_view();
+        }
+        size_t HeaderCount() const{
+            return headerCount_;
+        }
+        std::string_view HeaderName(size_t i) const{
+            return View_(headers_[i].name);
+        }
+        std::string_view HeaderValue(size_t i) const{
+            return View_(headers_[i].value);
+        }
+        /**
+         * @brief 按名字查找头部，名字不区分大小写
+         *
+         * @param name
+         * @return std::string_view 没有这个头部时为空
+         */
+        std::string_view GetHeader(std::string_view name) const;
+        bool HasHeader(std::string_view name) const;
+        size_t ContentLength() const{
+            return contentLength_;
+        }
+        /**
+         * @brief 应答之后是否保持连接，出错的请求总是关闭
+         *
+         * @return true
+         * @return false
+         */
+        bool IsKeepAlive() const{
+            return keepAlive_ && state_ != INVALID;
+        }
+    private:
+        /**
+         * @brief 相对请求起点的一段数据
+         *
+         */
+        struct Span{
+            uint32_t off;
+            uint32_t len;
+        };
+        struct Header{
+            Span name;
+            Span value;
+        };
+        std::string_view View_(Span span) const{
+            return std::string_view(base_ + span.off, span.len);
+        }
+        /**
+         * @brief 解析[begin,end)的请求行，不包含行尾
+         *
+         * @param begin
+         * @param end
+         * @return true
+         * @return false
+         */
+        bool ParseRequestLine_(size_t begin, size_t end);
+        bool ParseHeader_(size_t begin, size_t end);
+        /**
+         * @brief 头部结束，确定消息体长度和连接是否保持
+         *
+         * @return true
+         * @return false
+         */
+        bool FinishHeaders_();
+        PARSE_RESULT Fail_(int code);
+        const char* base_;//最近一次解析的数据起点
+        PARSE_STATE state_;
+        int error_;
+        size_t pos_;//下一个未扫描的字节
+        size_t lineStart_;//当前行的起点
+        size_t bodyStart_;
+        size_t contentLength_;
+        Span method_;
+        Span path_;
+        Span query_;
+        Span version_;
+        size_t headerCount_;
+        Header headers_[MAX_HEADERS];
+        bool http11_;
+        bool hasContentLength_;
+        bool chunked_;//Transfer-Encoding不是identity
+        bool connClose_;
+        bool connKeepAlive_;
+        bool keepAlive_;
+};
+#endif
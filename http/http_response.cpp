@@ -0,0 +1,259 @@
+/**
+ * @file http_response.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "http_response.hpp"
+#include <cstring>
+#include <ctime>
+namespace {
+struct StatusEntry{
+    int code;
+    std::string_view line;//完整的状态行
+};
+constexpr StatusEntry STATUS[] = {
+    {200, "HTTP/1.1 200 OK\r\n"},
+    {204, "HTTP/1.1 204 No Content\r\n"},
+    {206, "HTTP/1.1 206 Partial Content\r\n"},
+    {301, "HTTP/1.1 301 Moved Permanently\r\n"},
+    {302, "HTTP/1.1 302 Found\r\n"},
+    {304, "HTTP/1.1 304 Not Modified\r\n"},
+    {400, "HTTP/1.1 400 Bad Request\r\n"},
+    {403, "HTTP/1.1 403 Forbidden\r\n"},
+    {404, "HTTP/1.1 404 Not Found\r\n"},
+    {405, "HTTP/1.1 405 Method Not Allowed\r\n"},
+    {408, "HTTP/1.1 408 Request Timeout\r\n"},
+    {413, "HTTP/1.1 413 Payload Too Large\r\n"},
+    {414, "HTTP/1.1 414 URI Too Long\r\n"},
+    {431, "HTTP/1.1 431 Request Header Fields Too Large\r\n"},
+    {500, "HTTP/1.1 500 Internal Server Error\r\n"},
+    {501, "HTTP/1.1 501 Not Implemented\r\n"},
+    {503, "HTTP/1.1 503 Service Unavailable\r\n"},
+    {505, "HTTP/1.1 505 HTTP Version Not Supported\r\n"},
+};
+constexpr size_t STATUS_COUNT = sizeof(STATUS) / sizeof(STATUS[0]);
+constexpr size_t INTERNAL_ERROR = 14;//500在STATUS中的下标
+static_assert(STATUS[INTERNAL_ERROR].code == 500, "INTERNAL_ERROR must index 500");
+/**
+ * @brief 状态码到STATUS下标的直接索引
+ *
+ */
+struct StatusIndex{
+    uint8_t index[600];//下标加1，0表示未知的状态码
+    constexpr StatusIndex() : index(){
+        for(size_t i = 0; i < STATUS_COUNT; i++){
+            index[STATUS[i].code] = static_cast<uint8_t>(i + 1);
+        }
+    }
+};
+constexpr StatusIndex STATUS_INDEX;
+inline const StatusEntry& FindStatus(int code){
+    if(code >= 0 && code < 600 && STATUS_INDEX.index[code]){
+        return STATUS[STATUS_INDEX.index[code] - 1];
+    }
+    return STATUS[INTERNAL_ERROR];
+}
+struct MimeEntry{
+    std::string_view suffix;
+    std::string_view line;//完整的Content-Type头部
+};
+constexpr MimeEntry MIME[] = {
+    {".html", "Content-Type: text/html; charset=utf-8\r\n"},
+    {".htm", "Content-Type: text/html; charset=utf-8\r\n"},
+    {".css", "Content-Type: text/css; charset=utf-8\r\n"},
+    {".js", "Content-Type: text/javascript; charset=utf-8\r\n"},
+    {".json", "Content-Type: application/json\r\n"},
+    {".txt", "Content-Type: text/plain; charset=utf-8\r\n"},
+    {".xml", "Content-Type: text/xml\r\n"},
+    {".png", "Content-Type: image/png\r\n"},
+    {".jpg", "Content-Type: image/jpeg\r\n"},
+    {".jpeg", "Content-Type: image/jpeg\r\n"},
+    {".gif", "Content-Type: image/gif\r\n"},
+    {".ico", "Content-Type: image/x-icon\r\n"},
+    {".svg", "Content-Type: image/svg+xml\r\n"},
+    {".webp", "Content-Type: image/webp\r\n"},
+    {".woff2", "Content-Type: font/woff2\r\n"},
+    {".mp3", "Content-Type: audio/mpeg\r\n"},
+    {".mp4", "Content-Type: video/mp4\r\n"},
+    {".pdf", "Content-Type: application/pdf\r\n"},
+    {".wasm", "Content-Type: application/wasm\r\n"},
+};
+constexpr std::string_view MIME_DEFAULT = "Content-Type: text/plain; charset=utf-8\r\n";
+constexpr std::string_view SERVER = "Server: webserver\r\n";
+constexpr std::string_view KEEP_ALIVE = "Connection: keep-alive\r\n";
+constexpr std::string_view CLOSE = "Connection: close\r\n";
+constexpr std::string_view CONTENT_LENGTH = "Content-Length: ";
+constexpr std::string_view CRLF = "\r\n";
+/**
+ * @brief 00到99的两位数字
+ *
+ */
+struct DigitPairs{
+    char digits[200];
+    constexpr DigitPairs() : digits(){
+        for(int i = 0; i < 100; i++){
+            digits[i * 2] = static_cast<char>('0' + i / 10);
+            digits[i * 2 + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+constexpr DigitPairs DIGITS;
+inline void Write2(char* out, int value){
+    out[0] = DIGITS.digits[value * 2];
+    out[1] = DIGITS.digits[value * 2 + 1];
+}
+/**
+ * @brief 每个线程缓存的Date头部，秒数变化时重新格式化
+ *
+ */
+struct DateLine{
+    time_t sec = -1;
+    char line[40];//"Date: Sun, 06 Nov 1994 08:49:37 GMT\r\n"
+    size_t len = 0;
+};
+thread_local DateLine t_date;
+void FormatDate(DateLine& date, time_t sec){
+    static const char WEEKDAYS[] = "SunMonTueWedThuFriSat";
+    static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    char* p = date.line;
+    memcpy(p, "Date: ", 6);
+    p += 6;
+    memcpy(p, WEEKDAYS + tm.tm_wday * 3, 3);
+    p += 3;
+    *p++ = ',';
+    *p++ = ' ';
+    Write2(p, tm.tm_mday);
+    p += 2;
+    *p++ = ' ';
+    memcpy(p, MONTHS + tm.tm_mon * 3, 3);
+    p += 3;
+    *p++ = ' ';
+    int year = tm.tm_year + 1900;
+    Write2(p, year / 100 % 100);
+    Write2(p + 2, year % 100);
+    p += 4;
+    *p++ = ' ';
+    Write2(p, tm.tm_hour);
+    p[2] = ':';
+    Write2(p + 3, tm.tm_min);
+    p[5] = ':';
+    Write2(p + 6, tm.tm_sec);
+    p += 8;
+    memcpy(p, " GMT\r\n", 6);
+    p += 6;
+    date.len = p - date.line;
+    date.sec = sec;
+}
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::Status(int code){
+    std::string_view line = FindStatus(code).line;
+    buff_.Append(line.data(), line.size());
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::Server(){
+    buff_.Append(SERVER.data(), SERVER.size());
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::Date(){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME_COARSE, &ts);//粗粒度时钟走vDSO，精度足够到秒
+    if(ts.tv_sec != t_date.sec){
+        FormatDate(t_date, ts.tv_sec);
+    }
+    buff_.Append(t_date.line, t_date.len);
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::KeepAlive(bool keepAlive){
+    std::string_view line = keepAlive ? KEEP_ALIVE : CLOSE;
+    buff_.Append(line.data(), line.size());
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::ContentType(std::string_view path){
+    std::string_view line = MIME_DEFAULT;
+    size_t dot = path.rfind('.');
+    if(dot != std::string_view::npos && path.find('/', dot) == std::string_view::npos){
+        std::string_view suffix = path.substr(dot);
+        for(const MimeEntry& mime : MIME){
+            if(suffix == mime.suffix){
+                line = mime.line;
+                break;
+            }
+        }
+    }
+    buff_.Append(line.data(), line.size());
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::ContentLength(uint64_t len){
+    buff_.EnsureWriteable(CONTENT_LENGTH.size() + 20 + CRLF.size());
+    char* p = buff_.BeginWrite();
+    memcpy(p, CONTENT_LENGTH.data(), CONTENT_LENGTH.size());
+    size_t n = CONTENT_LENGTH.size();
+    n += FormatUint(p + n, len);
+    memcpy(p + n, CRLF.data(), CRLF.size());
+    buff_.HasWritten(n + CRLF.size());
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::Header(std::string_view name, std::string_view value){
+    size_t len = name.size() + 2 + value.size() + CRLF.size();
+    buff_.EnsureWriteable(len);
+    char* p = buff_.BeginWrite();
+    memcpy(p, name.data(), name.size());
+    p += name.size();
+    *p++ = ':';
+    *p++ = ' ';
+    memcpy(p, value.data(), value.size());
+    p += value.size();
+    memcpy(p, CRLF.data(), CRLF.size());
+    buff_.HasWritten(len);
+    return *this;
+}
+template<typename BufferType>
+BasicHttpResponse<BufferType>& BasicHttpResponse<BufferType>::Lines(std::string_view lines){
+    buff_.Append(lines.data(), lines.size());
+    return *this;
+}
+template<typename BufferType>
+void BasicHttpResponse<BufferType>::End(){
+    buff_.Append(CRLF.data(), CRLF.size());
+}
+template<typename BufferType>
+std::string_view BasicHttpResponse<BufferType>::StatusText(int code){
+    std::string_view line = FindStatus(code).line;
+    return line.substr(9, line.size() - 9 - CRLF.size());//去掉"HTTP/1.1 "和行尾
+}
+template<typename BufferType>
+size_t BasicHttpResponse<BufferType>::FormatUint(char* out, uint64_t value){
+    size_t len = 1;
+    for(uint64_t v = value; v >= 10; v /= 10){
+        len++;
+    }
+    char* p = out + len;
+    while(value >= 100){//每次写两位
+        p -= 2;
+        Write2(p, static_cast<int>(value % 100));
+        value /= 100;
+    }
+    if(value >= 10){
+        Write2(p - 2, static_cast<int>(value));
+    }else{
+        p[-1] = static_cast<char>('0' + value);
+    }
+    return len;
+}
+
+template class BasicHttpResponse<Buffer>;
+template class BasicHttpResponse<ChainBuffer>;
@@ -0,0 +1,104 @@
+/**
+ * @file http_response.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 直接写入缓冲的HTTP响应头
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _HTTP_RESPONSE_HPP_
+#define _HTTP_RESPONSE_HPP_
+#include "../buffer/buffer.hpp"
+#include "../buffer/chain_buffer.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+/**
+ * @brief HTTP响应头的生成器
+ * 状态行、Server、Connection和各种Content-Type头部都是编译期生成的完整行，直接拷贝到输出缓冲；
+ * Date头部每个线程每秒只格式化一次；Content-Length用查表的整数格式化直接写进缓冲。
+ * 生成一个普通的200响应头不分配内存，也不调用snprintf。
+ * 输出缓冲可以是Buffer或者ChainBuffer，只用到Append、EnsureWriteable、BeginWrite和HasWritten
+ */
+template<typename BufferType>
+class BasicHttpResponse{
+    public:
+        explicit BasicHttpResponse(BufferType& buff) : buff_(buff){}
+        /**
+         * @brief 写入状态行，未知的状态码按500处理
+         *
+         * @param code
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& Status(int code);
+        BasicHttpResponse& Server();
+        /**
+         * @brief 写入当前时间的Date头部
+         *
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& Date();
+        BasicHttpResponse& KeepAlive(bool keepAlive);
+        /**
+         * @brief 按文件后缀写入Content-Type头部，未知后缀按text/plain处理
+         *
+         * @param path
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& ContentType(std::string_view path);
+        BasicHttpResponse& ContentLength(uint64_t len);
+        /**
+         * @brief 写入一个头部
+         *
+         * @param name
+         * @param value
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& Header(std::string_view name, std::string_view value);
+        /**
+         * @brief 写入已经是完整行的头部，每行以\r\n结尾
+         *
+         * @param lines
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& Lines(std::string_view lines);
+        /**
+         * @brief 状态行和每个响应都有的头部：Server、Date和Connection
+         *
+         * @param code
+         * @param keepAlive
+         * @return BasicHttpResponse&
+         */
+        BasicHttpResponse& Head(int code, bool keepAlive){
+            return Status(code).Server().Date().KeepAlive(keepAlive);
+        }
+        /**
+         * @brief 写入结束响应头的空行
+         *
+         */
+        void End();
+        /**
+         * @brief 状态码和原因短语，比如"404 Not Found"
+         *
+         * @param code
+         * @return std::string_view
+         */
+        static std::string_view StatusText(int code);
+        /**
+         * @brief 把无符号整数格式化为十进制
+         *
+         * @param out 至少20字节
+         * @param value
+         * @return size_t 写入的字节数
+         */
+        static size_t FormatUint(char* out, uint64_t value);
+    private:
+        BufferType& buff_;
+};
+extern template class BasicHttpResponse<Buffer>;
+extern template class BasicHttpResponse<ChainBuffer>;
+using HttpResponse = BasicHttpResponse<ChainBuffer>;//连接的写缓冲是ChainBuffer
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @file static_file.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "static_file.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+StaticFile::~StaticFile(){
+    Close();
+}
+
+bool StaticFile::Open(const std::string& path, SEND_MODE mode){
+    Close();
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return false;
+    }
+    struct stat st;
+    if(fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)){//只发送普通文件
+        close(fd);
+        return false;
+    }
+    fd_ = fd;
+    size_ = st.st_size;
+    mtime_ = st.st_mtime;
+    offset_ = 0;
+    mode_ = mode;
+    if(mode_ == MMAP && size_ > 0){
+        void* addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if(addr == MAP_FAILED){//映射失败就退回sendfile
+            mode_ = SENDFILE;
+        }else{
+            map_ = static_cast<const char*>(addr);
+        }
+    }
+    return true;
+}
+
+void StaticFile::Attach(std::shared_ptr<const CachedFile> file){
+    Close();
+    cached_ = std::move(file);
+    map_ = cached_->data;
+    size_ = cached_->size;
+    mtime_ = cached_->mtime;
+    offset_ = 0;
+    mode_ = MMAP;
+}
+
+void StaticFile::Close(){
+    if(map_ && !cached_){
+        munmap(const_cast<char*>(map_), size_);
+    }
+    map_ = nullptr;
+    cached_.reset();
+    if(fd_ >= 0){
+        close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+    offset_ = 0;
+}
+
+ssize_t StaticFile::SendTo(int sock, Buffer& header, int* savedErrno){
+    ssize_t total = 0;
+    while(header.ReadableBytes() > 0 || !Done()){
+        const size_t header_len = header.ReadableBytes();
+        ssize_t len = 0;
+        if(mode_ == MMAP){//响应头和映射的文件内容一起写出
+            struct iovec body;
+            body.iov_base = const_cast<char*>(map_ + offset_);
+            body.iov_len = Remaining();
+            len = header.WriteFdWith(sock, &body, Done() ? 0 : 1, savedErrno);
+            if(len < 0){
+                return -1;
+            }
+            if(static_cast<size_t>(len) > header_len){
+                offset_ += len - header_len;
+            }
+        }else if(header_len > 0){//先写出响应头
+            len = header.WriteFdWith(sock, nullptr, 0, savedErrno);
+            if(len < 0){
+                return -1;
+            }
+        }else{//文件内容由内核直接发送
+            off_t off = offset_;
+            len = sendfile(sock, fd_, &off, Remaining());
+            if(len < 0){
+                if(errno == EINTR){
+                    continue;
+                }
+                *savedErrno = errno;
+                return -1;
+            }
+            offset_ = off;
+        }
+        if(len == 0){//对端不再接收
+            *savedErrno = EPIPE;
+            return -1;
+        }
+        total += len;
+    }
+    return total;
+}
+
+ssize_t StaticFile::ReadTo(Buffer& buff, int* savedErrno){
+    if(Done()){
+        return 0;
+    }
+    size_t remaining = Remaining();
+    if(map_){
+        buff.Append(map_ + offset_, remaining);
+        offset_ = size_;
+        return remaining;
+    }
+    if(lseek(fd_, offset_, SEEK_SET) < 0){
+        *savedErrno = errno;
+        return -1;
+    }
+    ssize_t len = buff.ReadFile(fd_, remaining, savedErrno);
+    if(len > 0){
+        offset_ += len;
+    }
+    return len;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file static_file.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 静态文件发送
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _STATIC_FILE_HPP_
+#define _STATIC_FILE_HPP_
+#include "../buffer/buffer.hpp"
+#include "file_cache.hpp"
+#include <cstddef>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <sys/types.h>
+/**
+ * @brief 静态文件
+ * 响应头从Buffer用writev写出，文件内容用sendfile直接从内核发送到套接字，
+ * 或者映射到内存后和响应头一起writev，文件内容都不会拷贝到用户态缓冲
+ */
+class StaticFile{
+    public:
+        /**
+         * @brief 文件内容的发送方式
+         *
+         */
+        enum SEND_MODE{
+            SENDFILE = 0,
+            MMAP = 1
+        };
+        StaticFile() = default;
+        ~StaticFile();
+        StaticFile(const StaticFile&) = delete;
+        StaticFile& operator=(const StaticFile&) = delete;
+        /**
+         * @brief 打开普通文件
+         *
+         * @param path
+         * @param mode
+         * @return true 打开成功
+         * @return false 文件不存在或者不是普通文件，映射失败时退回sendfile
+         */
+        bool Open(const std::string& path, SEND_MODE mode = SENDFILE);
+        /**
+         * @brief 发送缓存中的文件，内容和响应头一起writev
+         *
+         * @param file
+         */
+        void Attach(std::shared_ptr<const CachedFile> file);
+        /**
+         * @brief 关闭文件并解除映射
+         *
+         */
+        void Close();
+        /**
+         * @brief 发送响应头和文件内容，可以在非阻塞套接字上反复调用直到Done
+         *
+         * @param sock
+         * @param header 响应头，发送的部分会被读取
+         * @param savedErrno
+         * @return ssize_t 本次发送的字节数，出错返回-1
+         */
+        ssize_t SendTo(int sock, Buffer& header, int* savedErrno);
+        /**
+         * @brief 把文件剩余内容用read读入缓冲，用于不能直接发送文件的场合
+         *
+         * @param buff
+         * @param savedErrno
+         * @return ssize_t
+         */
+        ssize_t ReadTo(Buffer& buff, int* savedErrno);
+        /**
+         * @brief 文件内容是否已经全部发送
+         *
+         * @return true
+         * @return false
+         */
+        bool Done() const{
+            return offset_ >= size_;
+        }
+        bool IsOpen() const{
+            return fd_ >= 0;
+        }
+        size_t Size() const{
+            return size_;
+        }
+        size_t Remaining() const{
+            return size_ - offset_;
+        }
+        time_t ModifyTime() const{
+            return mtime_;
+        }
+    private:
+        int fd_ = -1;//文件描述符
+        SEND_MODE mode_ = SENDFILE;//发送方式
+        const char* map_ = nullptr;//映射的地址
+        std::shared_ptr<const CachedFile> cached_;//来自缓存的文件，发送期间保持有效
+        size_t size_ = 0;//文件大小
+        size_t offset_ = 0;//已经发送的文件内容
+        time_t mtime_ = 0;//修改时间
+};
+#endif
@@ -0,0 +1,228 @@
+/**
+ * @file binary_log.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 二进制结构化日志的记录格式和编译期格式检查
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _BINARY_LOG_H_
+#define _BINARY_LOG_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+/*
+ * 文件格式(本机字节序):
+ *   文件头      "WSBLOG01"，只在新文件开头写一次
+ *   格式描述    u8 RECORD_DESCRIPTOR | u32 id | u8 level | u8 argc | u32 line | u16 格式长度 | u16 文件名长度 | u8 参数类型[argc] | 格式 | 文件名
+ *   结构化记录  u8 RECORD_EVENT | u32 id | i64 微秒时间戳 | u16 参数长度 | 参数
+ *   文本记录    u8 RECORD_TEXT | u8 level | i64 微秒时间戳 | u16 长度 | 格式化好的内容
+ * 整数、浮点数和指针参数都按8字节保存，字符串保存为u16长度加内容。
+ * 参数类型的低4位是LOG_ARG，整数参数的高4位是默认参数提升后的字节数，解码时按这个宽度截断，高4位为0时按8字节处理。
+ * 每个文件打开时重新写入所有格式描述，同一个文件里id重复出现时以后面的描述为准
+ */
+static const char LOG_BINARY_MAGIC[8] = {'W','S','B','L','O','G','0','1'};
+static const size_t LOG_RECORD_MAX = 4096;//单条记录的最大字节数
+enum LOG_RECORD{
+    RECORD_DESCRIPTOR = 1,
+    RECORD_EVENT = 2,
+    RECORD_TEXT = 3
+};
+static const size_t LOG_EVENT_HEADER = 1 + 4 + 8 + 2;
+static const size_t LOG_TEXT_HEADER = 1 + 1 + 8 + 2;
+static const size_t LOG_DESCRIPTOR_HEADER = 1 + 4 + 1 + 1 + 4 + 2 + 2;
+enum LOG_ARG{
+    ARG_INT = 1,
+    ARG_UINT = 2,
+    ARG_DOUBLE = 3,
+    ARG_STRING = 4,
+    ARG_POINTER = 5
+};
+/**
+ * @brief 参数类型字节里的LOG_ARG
+ *
+ * @param tag
+ * @return uint8_t
+ */
+constexpr uint8_t LogArgType(uint8_t tag){
+    return tag & 0x0f;
+}
+/**
+ * @brief 参数类型字节里整数参数的字节数
+ *
+ * @param tag
+ * @return size_t 没有记录宽度时返回8
+ */
+constexpr size_t LogArgWidth(uint8_t tag){
+    return (tag >> 4) ? (tag >> 4) : 8;
+}
+/**
+ * @brief 参数类型，只支持可以直接传给printf的类型，其他类型编译失败
+ *
+ * @tparam T
+ * @tparam typename
+ */
+template<typename T, typename = void>
+struct LogArgTraits;
+template<typename T>
+struct LogArgTraits<T, typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type>{
+    static constexpr uint8_t type = ARG_INT;
+    static constexpr uint8_t tag = type | (sizeof(T) < sizeof(int) ? sizeof(int) : sizeof(T)) << 4;//char和short按int传给printf
+};
+template<typename T>
+struct LogArgTraits<T, typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type>{
+    static constexpr uint8_t type = ARG_UINT;
+    static constexpr uint8_t tag = type | (sizeof(T) < sizeof(int) ? sizeof(int) : sizeof(T)) << 4;
+};
+template<typename T>
+struct LogArgTraits<T, typename std::enable_if<std::is_floating_point<T>::value>::type>{
+    static constexpr uint8_t type = ARG_DOUBLE;
+    static constexpr uint8_t tag = type;
+};
+template<typename T>
+struct LogArgTraits<T*, typename std::enable_if<std::is_same<typename std::remove_cv<T>::type, char>::value>::type>{
+    static constexpr uint8_t type = ARG_STRING;
+    static constexpr uint8_t tag = type;
+};
+template<typename T>
+struct LogArgTraits<T*, typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type>{
+    static constexpr uint8_t type = ARG_POINTER;
+    static constexpr uint8_t tag = type;
+};
+/**
+ * @brief 格式串里从pos开始的下一个转换说明符
+ *
+ * @param format
+ * @param pos 输入开始位置，返回转换字符之后的位置
+ * @return char 转换字符，没有更多时返回0，不支持的写法返回'?'
+ */
+constexpr char LogNextConversion(const char* format, size_t& pos){
+    while(format[pos]){
+        if(format[pos++] != '%'){
+            continue;
+        }
+        if(format[pos] == '%'){
+            pos++;
+            continue;
+        }
+        while(format[pos] == '-' || format[pos] == '+' || format[pos] == ' ' || format[pos] == '#' || format[pos] == '0' ||
+              (format[pos] >= '1' && format[pos] <= '9') || format[pos] == '.' || format[pos] == 'l' || format[pos] == 'h' ||
+              format[pos] == 'z' || format[pos] == 'j' || format[pos] == 't' || format[pos] == 'L' || format[pos] == 'q'){
+            pos++;
+        }
+        if(!format[pos] || format[pos] == '*' || format[pos] == 'n'){//不支持运行时宽度和%n
+            return '?';
+        }
+        return format[pos++];
+    }
+    return 0;
+}
+/**
+ * @brief 转换字符能否接受这种参数
+ *
+ * @param conversion
+ * @param type
+ * @return true
+ * @return false
+ */
+constexpr bool LogConversionAccepts(char conversion, uint8_t type){
+    switch(conversion){
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            return type == ARG_INT || type == ARG_UINT;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            return type == ARG_DOUBLE;
+        case 's':
+            return type == ARG_STRING;
+        case 'p':
+            return type == ARG_POINTER;
+        default:
+            return false;
+    }
+}
+/**
+ * @brief 编译期检查格式串和参数，计算记录的大小限制
+ *
+ * @tparam Tuple 参数类型的tuple
+ */
+template<typename Tuple>
+struct LogFormatChecker;
+template<typename... Args>
+struct LogFormatChecker<std::tuple<Args...>>{
+    static constexpr uint8_t count = sizeof...(Args);
+    static constexpr uint8_t types[sizeof...(Args) + 1] = {LogArgTraits<Args>::tag..., 0};
+    static constexpr size_t strings = (0 + ... + (LogArgTraits<Args>::type == ARG_STRING ? 1 : 0));
+    static constexpr size_t fixed = LOG_EVENT_HEADER + (0 + ... + (LogArgTraits<Args>::type == ARG_STRING ? 2 : 8));
+    static_assert(sizeof...(Args) < 64 && fixed + strings * 16 <= LOG_RECORD_MAX, "too many log arguments");
+    static constexpr size_t string_max = strings ? (LOG_RECORD_MAX - fixed) / (strings ? strings : 1) : 0;//每个字符串参数最多保存的字节数
+    static constexpr bool Check(const char* format){
+        size_t pos = 0;
+        size_t arg = 0;
+        while(true){
+            char conversion = LogNextConversion(format, pos);
+            if(!conversion){
+                return arg == count;
+            }
+            if(arg >= count || !LogConversionAccepts(conversion, LogArgType(types[arg]))){
+                return false;
+            }
+            arg++;
+        }
+    }
+};
+/**
+ * @brief 日志调用点的静态描述，第一次使用时登记并分配id
+ *
+ */
+struct LogDescriptor{
+    int level;
+    const char* format;
+    const char* file;
+    int line;
+    uint8_t argc;
+    const uint8_t* types;
+    size_t string_max;
+    std::atomic<uint32_t> id{0};//0表示还没有登记
+};
+/**
+ * @brief 追加一个参数到记录里
+ *
+ * @tparam T
+ * @param p
+ * @param value
+ * @param string_max 字符串参数最多保存的字节数
+ * @return char* 写入后的位置
+ */
+template<typename T>
+inline char* LogEncodeArg(char* p, T value, size_t string_max){
+    constexpr uint8_t type = LogArgTraits<T>::type;
+    if constexpr(type == ARG_STRING){
+        const char* s = value ? value : "(null)";
+        uint16_t len = static_cast<uint16_t>(strnlen(s, string_max));
+        memcpy(p, &len, 2);
+        memcpy(p + 2, s, len);
+        return p + 2 + len;
+    }else if constexpr(type == ARG_INT){
+        int64_t v = value;
+        memcpy(p, &v, 8);
+        return p + 8;
+    }else if constexpr(type == ARG_UINT){
+        uint64_t v = value;
+        memcpy(p, &v, 8);
+        return p + 8;
+    }else if constexpr(type == ARG_DOUBLE){
+        double v = value;
+        memcpy(p, &v, 8);
+        return p + 8;
+    }else{
+        uint64_t v = reinterpret_cast<uintptr_t>(value);
+        memcpy(p, &v, 8);
+        return p + 8;
+    }
+}
+#endif
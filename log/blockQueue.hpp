@@ -9,21 +9,44 @@
  * 
  */
 #pragma once
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <mutex>
+#include <utility>
+#include <vector>
 #ifndef _BLOCK_QUEUE_H
 #define _BLOCK_QUEUE_H
 #include<deque>
 #include <condition_variable>
+/**
+ * @brief 队列满时放入的处理方式
+ *
+ */
+enum QUEUE_OVERFLOW{
+    OVERFLOW_BLOCK = 0,//等待有空位
+    OVERFLOW_DROP_NEWEST = 1,//丢弃要放入的元素
+    OVERFLOW_DROP_OLDEST = 2,//丢弃队头最旧的元素，放入新元素
+    OVERFLOW_SAMPLE = 3//每sampleRate个溢出的元素保留一个(替换最旧的)，其余丢弃
+};
 /**
  * @brief 阻塞队列
- * 
+ * 带超时的pop和pop_bulk的超时都是std::chrono::milliseconds，也可以直接传std::chrono::seconds
+ *
  * @tparam T 
  */
 template<typename T>
 class BlockQueue{
     public:
-        explicit BlockQueue(size_t MaxCapacity);
+        /**
+         * @brief 创建队列
+         *
+         * @param MaxCapacity 容量
+         * @param policy 队列满时的处理方式，push_front总是等待
+         * @param sampleRate OVERFLOW_SAMPLE时的采样间隔
+         */
+        explicit BlockQueue(size_t MaxCapacity, QUEUE_OVERFLOW policy = OVERFLOW_BLOCK, size_t sampleRate = 100);
         ~BlockQueue();
         void clear();
         bool empty() ;
@@ -33,22 +56,99 @@ class BlockQueue{
         size_t capacity() ;
         T front();
         T back();
-        void push_back(const T& item);
+        /**
+         * @brief 放入一个元素，队列满时按溢出策略处理
+         *
+         * @param item
+         * @return true
+         * @return false 元素被丢弃或者队列已经关闭
+         */
+        bool push_back(const T& item);
+        bool push_back(T&& item);
+        /**
+         * @brief 一次加锁放入[first,last)，队列满时对每个元素按溢出策略处理
+         *
+         * @tparam It
+         * @param first
+         * @param last
+         * @return size_t 放进队列的个数
+         */
+        template<typename It>
+        size_t push_bulk(It first, It last);
         void push_front(const T& item);
         bool pop(T &item);
-        bool pop(T &item,int timeout);
+        /**
+         * @brief 取出一个元素，最多等待timeout
+         *
+         * @param item
+         * @param timeout
+         * @return true
+         * @return false 超时或者队列已经关闭
+         */
+        bool pop(T &item,std::chrono::milliseconds timeout);
+        /**
+         * @brief 等到队列不为空，一次加锁取出最多max个元素追加到out
+         *
+         * @param out
+         * @param max
+         * @return size_t 取出的个数，0表示队列已经关闭
+         */
+        size_t pop_bulk(std::vector<T>& out, size_t max);
+        /**
+         * @brief 和pop_bulk一样，最多等待timeout
+         *
+         * @param out
+         * @param max
+         * @param timeout
+         * @return size_t 取出的个数，0表示超时或者队列已经关闭
+         */
+        size_t pop_bulk(std::vector<T>& out, size_t max, std::chrono::milliseconds timeout);
         void flush();
+        /**
+         * @brief 放入时队列已满的次数
+         *
+         * @return uint64_t
+         */
+        uint64_t overflows() const{
+            return overflows_.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief 因为溢出被丢弃的元素个数，包括丢弃的新元素和被挤掉的旧元素
+         *
+         * @return uint64_t
+         */
+        uint64_t dropped() const{
+            return dropped_.load(std::memory_order_relaxed);
+        }
     private:
+        /**
+         * @brief 持有锁时放入一个元素
+         *
+         * @return true
+         * @return false 元素被丢弃或者队列已经关闭
+         */
+        template<typename U>
+        bool PushLocked_(std::unique_lock<std::mutex>& locker, U&& item);
+        /**
+         * @brief 持有锁时取出最多max个元素
+         *
+         */
+        size_t PopLocked_(std::vector<T>& out, size_t max);
         std::deque<T> deq;//阻塞队列里面的队列
         size_t capacity_;//容量
         std::mutex mtx_;//互斥锁
         bool isClose_;//是否关闭阻塞队列
+        QUEUE_OVERFLOW policy_;//溢出策略
+        size_t sampleRate_;//采样间隔
+        std::atomic<uint64_t> overflows_;//溢出次数，修改时持有锁
+        std::atomic<uint64_t> dropped_;//丢弃个数，修改时持有锁
         std::condition_variable condConsumer;//消费者条件变量
         std::condition_variable condProducer;//生产者条件变量
 };
 #endif
 
-template <typename T> inline BlockQueue<T>::BlockQueue(size_t MaxCapacity):capacity_(MaxCapacity) {
+template <typename T> inline BlockQueue<T>::BlockQueue(size_t MaxCapacity, QUEUE_OVERFLOW policy, size_t sampleRate)
+    :capacity_(MaxCapacity),policy_(policy),sampleRate_(sampleRate > 0 ? sampleRate : 1),overflows_(0),dropped_(0) {
     assert(MaxCapacity>0);//断言最大容量大于0
     isClose_ = false;
 }
@@ -104,14 +204,65 @@ template <typename T> inline T BlockQueue<T>::front() {
  template <typename T> inline void BlockQueue<T>::flush() {
    condConsumer.notify_one(); // 唤醒等待的消费者
  }  
+ template<typename T>
+ template<typename U>
+ bool BlockQueue<T>::PushLocked_(std::unique_lock<std::mutex>& locker, U&& item){
+    if(deq.size()>=capacity_ && !isClose_){
+        uint64_t overflow = overflows_.load(std::memory_order_relaxed) + 1;
+        overflows_.store(overflow, std::memory_order_relaxed);
+        bool keep = policy_ == OVERFLOW_DROP_OLDEST || (policy_ == OVERFLOW_SAMPLE && overflow % sampleRate_ == 0);
+        if(policy_ == OVERFLOW_BLOCK){
+            while(deq.size()>=capacity_ && !isClose_){//当队列到达的最高容量时应该等待有空位
+                condProducer.wait(locker);//等待生产者条件变量
+            }
+        }else if(keep){//挤掉最旧的元素
+            deq.pop_front();
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }else{
+            dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+    if(isClose_){
+        return false;
+    }
+    deq.push_back(std::forward<U>(item));
+    return true;
+ }
  template<typename T> 
- void BlockQueue<T>::push_back(const T&item){
+ bool BlockQueue<T>::push_back(const T&item){
     std::unique_lock<std::mutex> locker(mtx_);
-    while(deq.size()>=capacity_){//当队列到达的最高容量时应该等待有空位
-        condProducer.wait(locker);//等待生产者条件变量
-    }
-    deq.push_back(item);
+    bool pushed = PushLocked_(locker, item);
+    locker.unlock();
     condConsumer.notify_one();
+    return pushed;
+ }
+ template<typename T>
+ bool BlockQueue<T>::push_back(T&&item){
+    std::unique_lock<std::mutex> locker(mtx_);
+    bool pushed = PushLocked_(locker, std::move(item));
+    locker.unlock();
+    condConsumer.notify_one();
+    return pushed;
+ }
+ template<typename T>
+ template<typename It>
+ size_t BlockQueue<T>::push_bulk(It first, It last){
+    size_t pushed = 0;
+    std::unique_lock<std::mutex> locker(mtx_);
+    for(; first != last; ++first){
+        if(policy_ == OVERFLOW_BLOCK && deq.size()>=capacity_ && pushed > 0){
+            condConsumer.notify_all();//等待空位之前先让消费者取走已经放入的元素
+        }
+        pushed += PushLocked_(locker, *first);
+    }
+    locker.unlock();
+    if(pushed > 1){
+        condConsumer.notify_all();
+    }else if(pushed == 1){
+        condConsumer.notify_one();
+    }
+    return pushed;
  }
  template<typename T> 
  void BlockQueue<T>::push_front(const T&item){
@@ -132,23 +283,65 @@ template <typename T> inline T BlockQueue<T>::front() {
             return false;
         }
     }
-    item = deq.front();
+    item = std::move(deq.front());
     deq.pop_front();
     condProducer.notify_one();//通知消费者
     return true;
  }
  template<typename T> 
- bool BlockQueue<T>::pop( T&item,int timeout){
+ bool BlockQueue<T>::pop( T&item,std::chrono::milliseconds timeout){
     std::unique_lock<std::mutex> locker(mtx_);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
     while (deq.empty())//队列为空就要等待消费者
     {
-        condConsumer.wait_for(locker,std::chrono::seconds(timeout));
-        if(isClose_){//如果队列关闭就直接退出不操作了
-            return false;
+        if(isClose_ || condConsumer.wait_until(locker, deadline) == std::cv_status::timeout){
+            if(isClose_ || deq.empty()){//关闭或者超时
+                return false;
+            }
+            break;
         }
     }
-    item = deq.front();
+    item = std::move(deq.front());
     deq.pop_front();
     condProducer.notify_one();//通知消费者
     return true;
- }
\ No newline at end of file
+ }
+ template<typename T>
+ size_t BlockQueue<T>::PopLocked_(std::vector<T>& out, size_t max){
+    size_t n = deq.size() < max ? deq.size() : max;
+    for(size_t i = 0; i < n; i++){
+        out.push_back(std::move(deq.front()));
+        deq.pop_front();
+    }
+    if(n > 1){//空出了多个位置
+        condProducer.notify_all();
+    }else if(n == 1){
+        condProducer.notify_one();
+    }
+    return n;
+ }
+ template<typename T>
+ size_t BlockQueue<T>::pop_bulk(std::vector<T>& out, size_t max){
+    std::unique_lock<std::mutex> locker(mtx_);
+    while(deq.empty()){
+        if(isClose_){
+            return 0;
+        }
+        condConsumer.wait(locker);
+    }
+    return PopLocked_(out, max);
+ }
+ template<typename T>
+ size_t BlockQueue<T>::pop_bulk(std::vector<T>& out, size_t max, std::chrono::milliseconds timeout){
+    std::unique_lock<std::mutex> locker(mtx_);
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while(deq.empty()){
+        if(isClose_ || condConsumer.wait_until(locker, deadline) == std::cv_status::timeout){
+            if(deq.empty()){
+                return 0;
+            }
+            break;
+        }
+    }
+    return PopLocked_(out, max);
+ }
@@ -1,133 +1,390 @@
 #include "log.hpp"
-#include "blockQueue.hpp"
-#include <bits/types/struct_timeval.h>
+#include "../pool/futex.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
 #include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
 #include <memory>
 #include <thread>
 #include <sys/stat.h>
-
-void Log::init(int level, const char *path, const char *suffix,
-               int maxQueueSize) {
-    isOpen_ = true;
-    level_  = level;
-    if(maxQueueSize>0){
-        isAsync_ = true;
-        if(!deque_){
-            std::unique_ptr<BlockQueue<std::string>> newDeque(new BlockQueue<std::string>(1024));
-            deque_ = std::move(newDeque);
-            std::unique_ptr<std::thread> NewThread(new std::thread());
-            writeThread_ = std::move(NewThread);
+#include <unistd.h>
+namespace {
+/**
+ * @brief 线程退出时标记暂存区关闭，后台线程写完剩余内容后删除
+ *
+ */
+struct StageHolder{
+    std::shared_ptr<LogStage> stage;
+    ~StageHolder(){
+        if(stage){
+            stage->closed.store(true, std::memory_order_release);
         }
-    }else{
-        isAsync_ = false;
-    }
-    lineCount_ = 0;
-    time_t timer = time(nullptr);
-    struct tm* sysTime = localtime(&timer);
-    struct tm t = *sysTime;
-    path = path;
-    suffix = suffix;
-    char fileName[LOG_NAME_LEN] = {0};
-    snprintf(fileName,LOG_NAME_LEN-1,"%s/%04d_%02d_%02d%s",path,t.tm_year+1900,t.tm_mon+1,t.tm_mday,suffix);
-    toDay_ = t.tm_mday;
+    }
+};
+thread_local StageHolder local_stage;
+}
+Log::Log():fileBytes_(0),fileHeader_(0),fileIndex_(0),nextRotate_(0),isOpen_(false),level_(INFO),
+    isAsync_(false),mode_(LOG_TEXT),descWritten_(0),fd_(-1),stageSize_(0),signal_(0),
+    overflow_(OVERFLOW_BLOCK),sampleRate_(100),overflows_(0),dropped_(0),stop_(false){
+}
+void Log::init(int level, const char *path, const char *suffix,
+               int maxQueueSize, LOG_MODE mode, const LogRotateOptions& rotate) {
+    level_.store(level, std::memory_order_relaxed);
+    mode_ = mode;
+    path_ = path;
+    suffix_ = suffix;
+    size_t want = std::max<size_t>(static_cast<size_t>(std::max(maxQueueSize, 0)) * AVG_LINE_LEN, LINE_MAX_LEN * 4);
+    stageSize_ = LINE_MAX_LEN;
+    while(stageSize_ < want){
+        stageSize_ <<= 1;
+    }
+    assert(rotate.interval_sec >= 0 && (rotate.interval_sec == 0 || 86400 % rotate.interval_sec == 0));
+    archiver_.Start(path_, suffix_, rotate.compress, rotate.keep_files);
     {
         std::lock_guard<std::mutex> locker(mtx_);
-        buff_.RetrieveAll();
-        if(fp){
-            flush();
-            fclose(fp);
+        rotate_ = rotate;
+        StartPeriod_(time(nullptr));
+        OpenFile_(0);
+    }
+    isAsync_ = maxQueueSize > 0;
+    if(isAsync_ && !writeThread_){
+        writeThread_.reset(new std::thread(FlushLogThread));
+    }
+    isOpen_.store(true, std::memory_order_release);
+}
+void Log::StartPeriod_(time_t now){
+    if(rotate_.interval_sec <= 0){
+        rotateTime_.Update(now);
+        nextRotate_ = 0;
+        return;
+    }
+    struct tm t;
+    localtime_r(&now, &t);
+    //按本地时间对齐到周期开始，每个周期只计算一次
+    time_t start = now - (t.tm_hour * 3600 + t.tm_min * 60 + t.tm_sec) % rotate_.interval_sec;
+    rotateTime_.Update(start);
+    nextRotate_ = start + rotate_.interval_sec;
+}
+std::string Log::FileName_(int index) const{
+    const struct tm& t = rotateTime_.Tm();
+    char fileName[LOG_NAME_LEN] = {0};
+    int n;
+    if(rotate_.interval_sec > 0 && rotate_.interval_sec < 86400){//不到一天的周期在文件名里加上开始的时分
+        n = snprintf(fileName, LOG_NAME_LEN - 1, "%s/%04d_%02d_%02d_%02d%02d",
+                     path_.c_str(), t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min);
+    }else{
+        n = snprintf(fileName, LOG_NAME_LEN - 1, "%s/%04d_%02d_%02d",
+                     path_.c_str(), t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+    }
+    if(index > 0){
+        snprintf(fileName + n, LOG_NAME_LEN - 1 - n, "-%d%s", index, suffix_.c_str());
+    }else{
+        snprintf(fileName + n, LOG_NAME_LEN - 1 - n, "%s", suffix_.c_str());
+    }
+    return fileName;
+}
+void Log::OpenFile_(int index){
+    struct stat st;
+    std::string fileName = FileName_(index);
+    while(stat((fileName + ".gz").c_str(), &st) == 0){//已经压缩过的序号不再使用，避免覆盖
+        fileName = FileName_(++index);
+    }
+    if(fd_ >= 0){
+        close(fd_);
+    }
+    fd_ = open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if(fd_ < 0){
+        mkdir(path_.c_str(), 0777);
+        fd_ = open(fileName.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+    assert(fd_ >= 0);
+    fileName_ = fileName;
+    fileIndex_ = index;
+    fileBytes_ = fstat(fd_, &st) == 0 ? st.st_size : 0;//追加到已有文件时接着计算大小
+    fileHeader_ = 0;
+    if(mode_ == LOG_BINARY){
+        if(fileBytes_ == 0){
+            iovec iov = {const_cast<char*>(LOG_BINARY_MAGIC), sizeof(LOG_BINARY_MAGIC)};
+            WriteAll_(&iov, 1);
+            fileBytes_ = fileHeader_ = sizeof(LOG_BINARY_MAGIC);
         }
-        fp = fopen(fileName,"a");
-        if (fp==nullptr){
-            mkdir(path,0777);
-            fp = fopen(fileName,"a");   
+        descWritten_ = 0;//每个文件都要能单独解码
+    }
+}
+void Log::CheckRotate_(size_t bytes){
+    time_t now = nextRotate_ > 0 ? time(nullptr) : 0;
+    bool period = nextRotate_ > 0 && now >= nextRotate_;
+    bool full = rotate_.max_bytes > 0 && fileBytes_ > fileHeader_ && fileBytes_ + bytes > rotate_.max_bytes;
+    if(period || full){
+        std::string old = std::move(fileName_);
+        if(period){
+            StartPeriod_(now);
+            OpenFile_(0);
+        }else{
+            OpenFile_(fileIndex_ + 1);
+        }
+        if(old != fileName_){//压缩和清理交给低优先级线程
+            archiver_.Submit(old, fileName_);
         }
-        assert(fp!=nullptr);
     }
+    fileBytes_ += bytes;
 }
 void Log::write(int level,const char *format,...){
+    va_list vaList;
+    va_start(vaList,format);
+    vwrite_(level, format, vaList);
+    va_end(vaList);
+}
+void Log::writeText_(int level,const char *format,...){
+    va_list vaList;
+    va_start(vaList,format);
+    vwrite_(level, format, vaList);
+    va_end(vaList);
+}
+void Log::vwrite_(int level,const char *format,va_list vaList){
+    thread_local LogTimeCache timeCache;
+    char* line = RecordBuffer_();
     struct timeval now = {0,0};
     gettimeofday(&now,nullptr);
-    time_t tSec = now.tv_sec;
-    struct tm*sysTime = localtime(&tSec);
-    struct tm t = *sysTime;
-    va_list vaList;
-    if(toDay_!=t.tm_mday||(lineCount_%MAX_LINES_)==0){
-        std::unique_lock<std::mutex> locker(mtx_);
-        locker.unlock();
-        char newFile[LOG_NAME_LEN];
-        char tail[36] = {0};
-        snprintf(tail, 36, "%04d_%02d_%02d", t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
-        if(toDay_ != t.tm_mday){
-            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s%s", path, tail, suffix);
-            toDay_ = t.tm_mday;
-            lineCount_ = 0;
-        }
-        else{
-            snprintf(newFile, LOG_NAME_LEN - 72, "%s/%s-%d%s", path, tail, (lineCount_  / MAX_LINES), suffix);
-        }
-        locker.lock();
-        flush();
-        fclose(fp);
-        fp = fopen(newFile,"a");
-        assert(fp!=nullptr);
-    }   
-
+    int n = 0;
+    if(mode_ == LOG_BINARY){//时间戳和等级按二进制保存，只格式化内容
+        n = LOG_TEXT_HEADER;
+    }else{
+        n = timeCache.Format(now, line);
+        n += AppendLogLevelTitle(line + n, level);
+    }
+    int m = vsnprintf(line + n, LINE_MAX_LEN - n, format, vaList);
+    if(m < 0){
+        m = 0;
+    }
+    n = std::min(n + m, LINE_MAX_LEN - 1);//截断时给换行留一个字节
+    if(mode_ == LOG_BINARY){
+        line[0] = RECORD_TEXT;
+        line[1] = static_cast<char>(level);
+        int64_t usec = static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+        memcpy(line + 2, &usec, 8);
+        uint16_t len = static_cast<uint16_t>(n - LOG_TEXT_HEADER);
+        memcpy(line + 10, &len, 2);
+    }else{
+        line[n++] = '\n';
+    }
+    AppendRecord_(line, n);
+}
+char* Log::RecordBuffer_(){
+    static_assert(LINE_MAX_LEN >= LOG_RECORD_MAX, "record buffer too small");
+    thread_local char record[LINE_MAX_LEN];
+    return record;
+}
+uint32_t Log::Register_(LogDescriptor& desc){
+    std::lock_guard<std::mutex> locker(registryMtx_);
+    uint32_t id = desc.id.load(std::memory_order_relaxed);
+    if(!id){//其他线程可能已经登记过
+        registry_.push_back(&desc);
+        id = static_cast<uint32_t>(registry_.size());
+        desc.id.store(id, std::memory_order_release);
+    }
+    return id;
+}
+void Log::FinishEvent_(char* record, uint32_t id, size_t len){
+    struct timeval now = {0,0};
+    gettimeofday(&now,nullptr);
+    int64_t usec = static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_usec;
+    uint16_t payload = static_cast<uint16_t>(len - LOG_EVENT_HEADER);
+    record[0] = RECORD_EVENT;
+    memcpy(record + 1, &id, 4);
+    memcpy(record + 5, &usec, 8);
+    memcpy(record + 13, &payload, 2);
+    AppendRecord_(record, len);
+}
+void Log::AppendRecord_(const char* record, size_t len){
+    if(!isAsync_){
+        std::lock_guard<std::mutex> locker(mtx_);
+        CheckRotate_(len);
+        if(mode_ == LOG_BINARY){
+            WriteDescriptors_();
+        }
+        iovec iov = {const_cast<char*>(record), len};
+        WriteAll_(&iov, 1);
+        return;
+    }
+    LogStage* stage = LocalStage_();
+    if(!stage->TryAppend(record, len)){
+        thread_local uint64_t overflowCount = 0;
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+        Notify_(stage);
+        int policy = overflow_.load(std::memory_order_relaxed);
+        if(policy != OVERFLOW_BLOCK &&
+           (policy != OVERFLOW_SAMPLE || ++overflowCount % sampleRate_.load(std::memory_order_relaxed) != 0)){
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        while(!stage->TryAppend(record, len)){//等后台线程写出
+            Notify_(stage);
+            std::this_thread::yield();
+        }
+    }
+    if(stage->Used() >= stage->Capacity() / 2){
+        Notify_(stage);
+    }
+}
+void Log::WriteDescriptors_(){
+    std::string out;
     {
-        std::unique_lock<std::mutex> locker(mtx_);
-        lineCount_++;
-        int n  = snprintf(buff_.BeginWrite(), 128, "%d-%02d-%02d %02d:%02d:%02d.%06ld ",
-                    t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
-                    t.tm_hour, t.tm_min, t.tm_sec, now.tv_usec);
-        buff_.HasWritten(n);
-        AppendLogLevelTitle(level);
-        va_start(vaList,format);
-        int m = vsnprintf(buff_.BeginWrite(),buff_.WriteableBytes(),format,vaList);
-        va_end(vaList);
-        buff_.HasWritten(m);
-        buff_.Append("\n\0",2);
-        if(isAsync_&&!deque_->full()){
-            deque_->push_back(buff_.RetrieveAllToStr());
-        }
-        else{
-            fputs(buff_.Peek(),fp);
-        }
-        buff_.RetrieveAll();
-    }
-}
-void Log::AppendLogLevelTitle (int level){
+        std::lock_guard<std::mutex> locker(registryMtx_);
+        for(; descWritten_ < registry_.size(); descWritten_++){
+            const LogDescriptor& desc = *registry_[descWritten_];
+            uint32_t id = static_cast<uint32_t>(descWritten_ + 1);
+            uint32_t line = static_cast<uint32_t>(desc.line);
+            uint16_t formatLen = static_cast<uint16_t>(strnlen(desc.format, UINT16_MAX));
+            uint16_t fileLen = static_cast<uint16_t>(strnlen(desc.file, UINT16_MAX));
+            char header[LOG_DESCRIPTOR_HEADER];
+            header[0] = RECORD_DESCRIPTOR;
+            memcpy(header + 1, &id, 4);
+            header[5] = static_cast<char>(desc.level);
+            header[6] = static_cast<char>(desc.argc);
+            memcpy(header + 7, &line, 4);
+            memcpy(header + 11, &formatLen, 2);
+            memcpy(header + 13, &fileLen, 2);
+            out.append(header, LOG_DESCRIPTOR_HEADER);
+            out.append(reinterpret_cast<const char*>(desc.types), desc.argc);
+            out.append(desc.format, formatLen);
+            out.append(desc.file, fileLen);
+        }
+    }
+    if(!out.empty()){
+        iovec iov = {&out[0], out.size()};
+        WriteAll_(&iov, 1);
+        fileBytes_ += out.size();
+    }
+}
+int Log::AppendLogLevelTitle (char* buff, int level){
     switch (level)
     {
         case LOG_LEVEL::DEBUG:{
-            buff_.Append("[debug]:",9);
-            break;
+            memcpy(buff, "[debug]:", 8);
+            return 8;
         }
-
         case LOG_LEVEL::INFO:{
-            buff_.Append("[info]:",8);
-            break;
+            memcpy(buff, "[info]:", 7);
+            return 7;
         }
         case LOG_LEVEL::WARN:{
-            buff_.Append("[warn]:",8);
-            break;
+            memcpy(buff, "[warn]:", 7);
+            return 7;
         }
         case LOG_LEVEL::ERROR:{
-            buff_.Append("[error]:",9);
-            break;
+            memcpy(buff, "[error]:", 8);
+            return 8;
         }
     }
+    return 0;
+}
+LogStage* Log::LocalStage_(){
+    if(!local_stage.stage){
+        local_stage.stage = std::make_shared<LogStage>(stageSize_);
+        std::lock_guard<std::mutex> locker(stagesMtx_);
+        stages_.push_back(local_stage.stage);
+    }
+    return local_stage.stage.get();
+}
+void Log::Notify_(LogStage* stage){
+    if(!stage->wake_pending.exchange(true, std::memory_order_acq_rel)){
+        signal_.fetch_add(1, std::memory_order_release);
+        FutexWake(&signal_, 1);
+    }
 }
 void Log::flush(){
     if(isAsync_){
-        deque_->full();
+        signal_.fetch_add(1, std::memory_order_release);
+        FutexWake(&signal_, 1);
     }
-    fflush(fp);
 }
-void Log::AsyncWrite(){
-    std::string str = "";
-    while(deque_->pop(str)){
+void Log::WriteAll_(iovec* iov, int count){
+    while(count > 0){
+        ssize_t len = writev(fd_, iov, std::min(count, IOV_MAX));
+        if(len < 0){
+            if(errno == EINTR){
+                continue;
+            }
+            return;//写失败时丢弃，不能让写日志的线程一直等待
+        }
+        while(count > 0 && static_cast<size_t>(len) >= iov->iov_len){
+            len -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if(count > 0){
+            iov->iov_base = static_cast<char*>(iov->iov_base) + len;
+            iov->iov_len -= len;
+        }
+    }
+}
+size_t Log::WriteBatch_(){
+    {
+        std::lock_guard<std::mutex> locker(stagesMtx_);
+        active_.clear();
+        for(auto& stage : stages_){
+            active_.push_back(stage.get());
+        }
+    }
+    iov_.resize(active_.size() * 2);
+    ends_.resize(active_.size());
+    closed_.assign(active_.size(), 0);
+    size_t bytes = 0;
+    int count = 0;
+    for(size_t i = 0; i < active_.size(); i++){
+        LogStage* stage = active_[i];
+        closed_[i] = stage->closed.load(std::memory_order_acquire);//先读关闭标记，之后取到的就是全部内容
+        int n = stage->GetReadIovec(&iov_[count], &ends_[i]);
+        for(int j = 0; j < n; j++){
+            bytes += iov_[count + j].iov_len;
+        }
+        count += n;
+    }
+    if(count > 0){
         std::lock_guard<std::mutex> locker(mtx_);
-        fputs(str.c_str(),fp);
+        CheckRotate_(bytes);
+        if(mode_ == LOG_BINARY){//登记在取暂存区之后读取，这一批用到的描述一定已经登记
+            WriteDescriptors_();
+        }
+        WriteAll_(iov_.data(), count);
+    }
+    bool removed = false;
+    for(size_t i = 0; i < active_.size(); i++){
+        active_[i]->Consume(ends_[i]);
+        active_[i]->wake_pending.store(false, std::memory_order_release);
+        removed = removed || closed_[i];
+    }
+    if(removed){
+        std::lock_guard<std::mutex> locker(stagesMtx_);
+        for(size_t i = 0; i < active_.size(); i++){
+            if(closed_[i]){
+                LogStage* stage = active_[i];
+                stages_.erase(std::remove_if(stages_.begin(), stages_.end(),
+                    [stage](const std::shared_ptr<LogStage>& s){ return s.get() == stage; }), stages_.end());
+            }
+        }
+    }
+    return bytes;
+}
+void Log::AsyncWrite(){
+    while(true){
+        uint32_t seq = signal_.load(std::memory_order_acquire);
+        bool stop = stop_.load(std::memory_order_acquire);
+        size_t bytes = WriteBatch_();
+        if(bytes > 0){//可能还有没取完的内容，继续写
+            continue;
+        }
+        if(stop){
+            break;
+        }
+        struct timespec ts;
+        ts.tv_sec = 0;
+        ts.tv_nsec = FLUSH_INTERVAL_MS * 1000000L;
+        FutexWait(&signal_, seq, &ts);
     }
 }
 Log* Log::Instance(){
@@ -138,28 +395,15 @@ void Log::FlushLogThread(){
     Log::Instance()->AsyncWrite();
 }
 Log::~Log() {
-
-  if (writeThread_ && writeThread_->joinable()) { // 关闭之前等待写线程结束
-    while (!deque_->empty()) // 不断处理队列剩下的内容
-    {
-      deque_->flush();
-    }
-    deque_->Close(); // 处理完毕关闭队列
+  if (writeThread_ && writeThread_->joinable()) { // 关闭之前等待写线程写完所有暂存区
+    stop_.store(true, std::memory_order_release);
+    signal_.fetch_add(1, std::memory_order_release);
+    FutexWake(&signal_, 1);
     writeThread_->join();
   }
-  if (fp) { // 处理文件指针
-    std::lock_guard<std::mutex> locker(mtx_);
-    flush();
-    fclose(fp);
+  std::lock_guard<std::mutex> locker(mtx_);
+  if (fd_ >= 0) {
+    close(fd_);
+    fd_ = -1;
   }
 }
-
-int Log::GetLevel(){
-    std::lock_guard<std::mutex> lokcer(mtx_);
-    return level_;
-}
-
-void Log::setLevel(int level){
-    std::lock_guard<std::mutex> lokcer(mtx_);
-    level_ = level;
-}
@@ -1,62 +1,275 @@
 /**
  * @file log.hpp
  * @author {gangx} ({gangx6906@gmail.com})
- * @brief 
+ * @brief
  * @version 0.1
  * @date 2024-05-04
- * 
+ *
  * @copyright Copyright (c) 2024
- * 
+ *
  */
 #pragma once
 #ifndef _LOG_H_
 #define _LOG_H_
-#include "../buffer/buffer.hpp"
+#include "binary_log.hpp"
 #include "blockQueue.hpp"
+#include "log_archiver.hpp"
+#include "log_stage.hpp"
+#include "log_time.hpp"
+#include <algorithm>
+#include <assert.h>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <sys/time.h>
+#include <sys/uio.h>
 #include <cstdarg>
 #include <thread>
+#include <vector>
 enum LOG_LEVEL{
     DEBUG = 0,
     INFO = 1,
     WARN = 2 ,
     ERROR = 3
 };
+enum LOG_MODE{
+    LOG_TEXT = 0,//文本日志
+    LOG_BINARY = 1//二进制结构化日志，用日志解码工具转换成文本
+};
+/**
+ * @brief 日志文件切换的配置，切换只在后台线程(同步模式下是写日志的线程)进行
+ *
+ */
+struct LogRotateOptions{
+    size_t max_bytes = 64 << 20;//单个文件的最大字节数，0表示不按大小切换
+    int interval_sec = 86400;//按本地时间对齐的切换周期，必须能整除一天，0表示不按时间切换
+    bool compress = true;//用gzip压缩切换下来的文件，编译时没有zlib则保留原文件
+    int keep_files = 0;//保留的历史文件个数，不包括正在写的文件，0表示不限制
+};
+/**
+ * @brief 日志
+ * 异步模式下每个写日志的线程在自己的暂存区里格式化并追加记录，不加锁也不分配内存；
+ * 后台线程定时或者在某个暂存区过半时被唤醒，把所有暂存区的内容用一次writev写进文件。
+ * 同步模式下直接在调用线程写文件。
+ * 二进制模式下LOG_STRUCT_*只把格式描述的id和原始参数写进暂存区，格式化推迟到离线解码；
+ * 普通的LOG_*在二进制模式下写成带等级和时间戳的文本记录
+ */
 class Log{
     public:
-        void init(int level,const char* path = "./log",const char* suffix = ".log",int maxQueueSize = 1024);
+        /**
+         * @brief 初始化日志
+         *
+         * @param level 日志等级
+         * @param path 日志目录
+         * @param suffix 日志文件后缀
+         * @param maxQueueSize 每个线程暂存区能放下的平均长度日志条数，大于0时使用异步模式
+         * @param mode 文本或者二进制
+         * @param rotate 文件切换的配置
+         */
+        void init(int level,const char* path = "./log",const char* suffix = ".log",int maxQueueSize = 1024,LOG_MODE mode = LOG_TEXT,
+                  const LogRotateOptions& rotate = LogRotateOptions());
         static Log* Instance();
         static void FlushLogThread();
-        void write(int level,const char * format ,...);
+        void write(int level,const char * format ,...) __attribute__((format(printf, 3, 4)));
+        /**
+         * @brief 写一条结构化日志，由LOG_STRUCT_*调用
+         * 文本模式下和write一样在调用线程格式化；二进制模式下只复制参数
+         *
+         * @tparam Args
+         * @param desc 调用点的静态描述
+         * @param args
+         */
+        template<typename... Args>
+        void writeStruct(LogDescriptor& desc, Args... args){
+            if(mode_ != LOG_BINARY){
+                writeText_(desc.level, desc.format, args...);
+                return;
+            }
+            uint32_t id = desc.id.load(std::memory_order_acquire);
+            if(!id){
+                id = Register_(desc);
+            }
+            char* record = RecordBuffer_();
+            char* p = record + LOG_EVENT_HEADER;
+            ((p = LogEncodeArg(p, args, desc.string_max)), ...);
+            FinishEvent_(record, id, p - record);
+        }
+        /**
+         * @brief 异步模式下唤醒后台线程立即写出暂存的日志
+         *
+         */
         void flush();
-        int GetLevel();
-        void setLevel(int level);
-        bool IsOpen(){
-            return isOpen_;
+        int GetLevel() const{
+            return level_.load(std::memory_order_relaxed);
+        }
+        void setLevel(int level){
+            level_.store(level, std::memory_order_relaxed);
+        }
+        bool IsOpen() const{
+            return isOpen_.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief 设置异步模式下暂存区满时的处理方式，默认等待后台线程写出
+         * 暂存区里已经提交的记录归后台线程所有，写日志的线程不能回收，
+         * 所以OVERFLOW_DROP_OLDEST按OVERFLOW_DROP_NEWEST处理；OVERFLOW_SAMPLE每sampleRate条溢出的记录等待写入一条
+         *
+         * @param policy
+         * @param sampleRate
+         */
+        void SetOverflow(QUEUE_OVERFLOW policy, int sampleRate = 100){
+            sampleRate_.store(std::max(sampleRate, 1), std::memory_order_relaxed);
+            overflow_.store(policy, std::memory_order_relaxed);
+        }
+        /**
+         * @brief 追加时暂存区已满的次数
+         *
+         * @return uint64_t
+         */
+        uint64_t Overflows() const{
+            return overflows_.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief 因为暂存区满被丢弃的记录条数
+         *
+         * @return uint64_t
+         */
+        uint64_t Dropped() const{
+            return dropped_.load(std::memory_order_relaxed);
         }
     private:
         Log();
-        void AppendLogLevelTitle(int levle);
+        int AppendLogLevelTitle(char* buff, int level);
+        void writeText_(int level, const char* format, ...);
+        void vwrite_(int level, const char* format, va_list vaList);
+        /**
+         * @brief 当前线程的记录缓冲区
+         *
+         * @return char* LOG_RECORD_MAX字节
+         */
+        static char* RecordBuffer_();
+        /**
+         * @brief 登记调用点，分配id
+         *
+         * @param desc
+         * @return uint32_t
+         */
+        uint32_t Register_(LogDescriptor& desc);
+        /**
+         * @brief 填写结构化记录的头部并追加
+         *
+         * @param record
+         * @param id
+         * @param len 包括头部的总长度
+         */
+        void FinishEvent_(char* record, uint32_t id, size_t len);
+        /**
+         * @brief 追加一条完整的记录，同步模式下直接写文件，异步模式下放进当前线程的暂存区
+         *
+         * @param record
+         * @param len
+         */
+        void AppendRecord_(const char* record, size_t len);
+        /**
+         * @brief 把当前文件还没有写过的格式描述写进去，调用者持有mtx_
+         *
+         */
+        void WriteDescriptors_();
         virtual ~Log();
+        /**
+         * @brief 后台线程主循环
+         *
+         */
         void AsyncWrite();
+        /**
+         * @brief 当前线程的暂存区，第一次调用时创建并登记
+         *
+         * @return LogStage*
+         */
+        LogStage* LocalStage_();
+        /**
+         * @brief 唤醒后台线程，同一个暂存区在后台线程处理之前只唤醒一次
+         *
+         * @param stage
+         */
+        void Notify_(LogStage* stage);
+        /**
+         * @brief 把所有暂存区的内容写进文件
+         *
+         * @return size_t 写出的字节数
+         */
+        size_t WriteBatch_();
+        /**
+         * @brief 写出所有iovec，处理部分写入，调用者持有mtx_
+         *
+         * @param iov
+         * @param count
+         */
+        void WriteAll_(iovec* iov, int count);
+        /**
+         * @brief 到了时间边界或者文件超过大小时切换文件，调用者持有mtx_
+         *
+         * @param bytes 马上要写入的字节数
+         */
+        void CheckRotate_(size_t bytes);
+        /**
+         * @brief 开始now所在的切换周期，调用者持有mtx_
+         *
+         * @param now
+         */
+        void StartPeriod_(time_t now);
+        /**
+         * @brief 打开当前周期里从index开始第一个没有被压缩过的文件，调用者持有mtx_
+         *
+         * @param index 周期里的序号，0表示不带序号
+         */
+        void OpenFile_(int index);
+        /**
+         * @brief 当前周期里序号为index的文件名
+         *
+         * @param index
+         * @return std::string
+         */
+        std::string FileName_(int index) const;
     private:
         static const int LOG_PATH_LEN = 256;
         static const int LOG_NAME_LEN = 256;
-        static const int MAX_LINES = 50000;
-        const char *path;
-        const char *suffix;
-        int MAX_LINES_;
-        int lineCount_;
-        int toDay_;
-        bool isOpen_;
-        Buffer buff_;
-        int level_;
+        static const int LINE_MAX_LEN = 4096;//单条日志的最大长度，超过的部分被截断
+        static const int AVG_LINE_LEN = 128;//估算暂存区大小时使用的平均长度
+        static const int FLUSH_INTERVAL_MS = 100;//后台线程没有被唤醒时的最长等待时间
+        std::string path_;
+        std::string suffix_;
+        LogRotateOptions rotate_;
+        std::string fileName_;//正在写的文件
+        size_t fileBytes_;//当前文件的字节数
+        size_t fileHeader_;//当前文件开头的文件头字节数，只有文件头的文件不按大小切换
+        int fileIndex_;//当前文件在周期里的序号
+        time_t nextRotate_;//下一个时间边界
+        LogTimeCache rotateTime_;//当前周期开始的时间，用来生成文件名，由mtx_保护
+        LogArchiver archiver_;
+        std::atomic<bool> isOpen_;
+        std::atomic<int> level_;
         bool isAsync_;
-        FILE *fp;
-        std::unique_ptr<BlockQueue<std::string>> deque_;
+        LOG_MODE mode_;
+        std::vector<LogDescriptor*> registry_;//按id排列的格式描述，id从1开始
+        std::mutex registryMtx_;
+        size_t descWritten_;//当前文件已经写过的格式描述个数，由mtx_保护
+        int fd_;
+        size_t stageSize_;//每个线程暂存区的字节数
+        std::vector<std::shared_ptr<LogStage>> stages_;//所有线程的暂存区，只有后台线程删除
+        std::mutex stagesMtx_;
+        std::vector<LogStage*> active_;//后台线程使用，复用内存
+        std::vector<iovec> iov_;
+        std::vector<uint64_t> ends_;
+        std::vector<char> closed_;
         std::unique_ptr<std::thread> writeThread_;
-        std::mutex mtx_;
+        std::atomic<uint32_t> signal_;//后台线程等待的futex字
+        std::atomic<int> overflow_;//暂存区满时的处理方式
+        std::atomic<int> sampleRate_;
+        std::atomic<uint64_t> overflows_;
+        std::atomic<uint64_t> dropped_;
+        std::atomic<bool> stop_;
+        std::mutex mtx_;//保护文件
 };
 #define LOG_BASE(level,format,...)\
     do\
@@ -64,7 +277,6 @@ class Log{
         Log *log = Log::Instance();\
         if(log->IsOpen()&&log->GetLevel()<=level){\
             log->write(level,format,##__VA_ARGS__);\
-            log->flush();\
         }\
     } while (0);
 #define LOG_DEBUG(format,...)do{LOG_BASE(DEBUG,format,##__VA_ARGS__)} while (0);
@@ -75,4 +287,26 @@ class Log{
 
 #define LOG_ERROR(format,...)do{LOG_BASE(ERROR,format,##__VA_ARGS__)} while (0);
 
+/**
+ * 结构化日志，格式串必须是字面量，编译期检查格式和参数的个数、类型是否匹配
+ */
+#define LOG_STRUCT(level,format,...)\
+    do\
+    {\
+        typedef LogFormatChecker<decltype(std::make_tuple(__VA_ARGS__))> LogChecker_;\
+        static_assert(LogChecker_::Check(format), "log format does not match arguments");\
+        Log *log = Log::Instance();\
+        if(log->IsOpen()&&log->GetLevel()<=level){\
+            static LogDescriptor logDesc_ = {level, format, __FILE__, __LINE__, LogChecker_::count, LogChecker_::types, LogChecker_::string_max};\
+            log->writeStruct(logDesc_, ##__VA_ARGS__);\
+        }\
+    } while (0);
+#define LOG_STRUCT_DEBUG(format,...)do{LOG_STRUCT(DEBUG,format,##__VA_ARGS__)} while (0);
+
+#define LOG_STRUCT_INFO(format,...)do{LOG_STRUCT(INFO,format,##__VA_ARGS__)} while (0);
+
+#define LOG_STRUCT_WARN(format,...)do{LOG_STRUCT(WARN,format,##__VA_ARGS__)} while (0);
+
+#define LOG_STRUCT_ERROR(format,...)do{LOG_STRUCT(ERROR,format,##__VA_ARGS__)} while (0);
+
 #endif
@@ -0,0 +1,146 @@
+#include "log_archiver.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cctype>
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+#ifdef LOG_USE_ZLIB
+#include <zlib.h>
+#endif
+namespace {
+bool EndsWith(const std::string& s, const std::string& tail){
+    return s.size() >= tail.size() && s.compare(s.size() - tail.size(), tail.size(), tail) == 0;
+}
+}
+LogArchiver::~LogArchiver(){
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    if(thread_.joinable()){
+        thread_.join();
+    }
+}
+void LogArchiver::Start(const std::string& dir, const std::string& suffix, bool compress, int keepFiles){
+    std::lock_guard<std::mutex> locker(mtx_);
+    dir_ = dir;
+    suffix_ = suffix;
+    compress_ = compress;
+    keepFiles_ = keepFiles;
+    if(!thread_.joinable()){
+        thread_ = std::thread([this]{ Run_(); });
+    }
+}
+void LogArchiver::Submit(const std::string& file, const std::string& active){
+    {
+        std::lock_guard<std::mutex> locker(mtx_);
+        files_.push_back(file);
+        active_ = active;
+    }
+    cond_.notify_one();
+}
+void LogArchiver::Run_(){
+    //只降低本线程的CPU和IO优先级，不影响写日志的线程
+    pid_t tid = static_cast<pid_t>(syscall(SYS_gettid));
+    setpriority(PRIO_PROCESS, tid, 19);
+    syscall(SYS_ioprio_set, 1, tid, 3 << 13);//IOPRIO_WHO_PROCESS, IOPRIO_CLASS_IDLE
+    std::unique_lock<std::mutex> locker(mtx_);
+    while(true){
+        cond_.wait(locker, [this]{ return stop_ || !files_.empty(); });
+        if(files_.empty()){
+            break;
+        }
+        std::string file = std::move(files_.front());
+        files_.pop_front();
+        std::string active = active_;
+        bool compress = compress_;
+        locker.unlock();
+        if(compress){
+            Compress_(file);
+        }
+        Prune_(active);
+        locker.lock();
+    }
+}
+void LogArchiver::Compress_(const std::string& file){
+#ifdef LOG_USE_ZLIB
+    int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0){
+        return;
+    }
+    struct stat st;
+    bool hasTime = fstat(fd, &st) == 0;
+    std::string tmp = file + ".gz.tmp";
+    gzFile gz = gzopen(tmp.c_str(), "wb6");
+    bool ok = gz != nullptr;
+    std::vector<char> buff(1 << 16);
+    while(ok){
+        ssize_t len = read(fd, buff.data(), buff.size());
+        if(len == 0){
+            break;
+        }
+        if(len < 0){
+            ok = errno == EINTR;
+            continue;
+        }
+        ok = gzwrite(gz, buff.data(), static_cast<unsigned>(len)) == len;
+    }
+    close(fd);
+    if(gz && gzclose(gz) != Z_OK){
+        ok = false;
+    }
+    if(ok && hasTime){//保留原文件的修改时间，清理时按时间排序
+        struct timespec times[2] = {st.st_atim, st.st_mtim};
+        utimensat(AT_FDCWD, tmp.c_str(), times, 0);
+    }
+    if(ok && rename(tmp.c_str(), (file + ".gz").c_str()) == 0){
+        unlink(file.c_str());
+    }else{//压缩失败就保留原文件
+        unlink(tmp.c_str());
+    }
+#else
+    (void)file;
+#endif
+}
+void LogArchiver::Prune_(const std::string& active){
+    if(keepFiles_ <= 0){
+        return;
+    }
+    DIR* dir = opendir(dir_.c_str());
+    if(!dir){
+        return;
+    }
+    //只处理日志自己生成的文件：以日期开头，以后缀或者后缀.gz结尾
+    std::vector<std::pair<int64_t, std::string>> files;//纳秒精度的修改时间，同一秒内切换多次也能排序
+    std::string gzSuffix = suffix_ + ".gz";
+    struct dirent* entry;
+    while((entry = readdir(dir))){
+        std::string name = entry->d_name;
+        if(name.empty() || !isdigit(static_cast<unsigned char>(name[0])) ||
+           !(EndsWith(name, suffix_) || EndsWith(name, gzSuffix))){
+            continue;
+        }
+        std::string path = dir_ + "/" + name;
+        struct stat st;
+        if(path == active || stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)){
+            continue;
+        }
+        files.emplace_back(static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec, path);
+    }
+    closedir(dir);
+    if(files.size() <= static_cast<size_t>(keepFiles_)){
+        return;
+    }
+    std::sort(files.begin(), files.end());
+    for(size_t i = 0; i + keepFiles_ < files.size(); i++){
+        unlink(files[i].second.c_str());
+    }
+}
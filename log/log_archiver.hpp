@@ -0,0 +1,74 @@
+/**
+ * @file log_archiver.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 切换下来的日志文件的压缩和清理
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _LOG_ARCHIVER_H_
+#define _LOG_ARCHIVER_H_
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+/**
+ * @brief 在低优先级线程上压缩切换下来的日志文件并按个数清理历史文件
+ * 写日志的后台线程只是把文件名放进队列，不会等待压缩和删除
+ */
+class LogArchiver{
+    public:
+        LogArchiver() = default;
+        /**
+         * @brief 处理完队列里的文件后退出
+         *
+         */
+        ~LogArchiver();
+        LogArchiver(const LogArchiver&) = delete;
+        LogArchiver& operator=(const LogArchiver&) = delete;
+        /**
+         * @brief 设置参数，第一次调用时启动线程
+         *
+         * @param dir 日志目录
+         * @param suffix 日志文件后缀
+         * @param compress 是否压缩，编译时没有zlib则忽略
+         * @param keepFiles 保留的历史文件个数，0表示不限制
+         */
+        void Start(const std::string& dir, const std::string& suffix, bool compress, int keepFiles);
+        /**
+         * @brief 提交一个已经关闭的文件
+         *
+         * @param file 切换下来的文件
+         * @param active 正在写的文件，清理时跳过
+         */
+        void Submit(const std::string& file, const std::string& active);
+    private:
+        void Run_();
+        /**
+         * @brief 压缩成file.gz并删除原文件
+         *
+         * @param file
+         */
+        void Compress_(const std::string& file);
+        /**
+         * @brief 删除最旧的历史文件，直到个数不超过keepFiles_
+         *
+         * @param active
+         */
+        void Prune_(const std::string& active);
+        std::string dir_;
+        std::string suffix_;
+        bool compress_ = false;
+        int keepFiles_ = 0;
+        std::deque<std::string> files_;
+        std::string active_;
+        bool stop_ = false;
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        std::thread thread_;
+};
+#endif
@@ -0,0 +1,216 @@
+#include "log_decoder.hpp"
+#include <cstdarg>
+#include <cstring>
+namespace {
+const char* LevelTitle(int level){
+    switch(level){
+        case 0: return "[debug]:";
+        case 1: return "[info]:";
+        case 2: return "[warn]:";
+        case 3: return "[error]:";
+        default: return "";
+    }
+}
+void AppendFormat(std::string& out, const char* format, ...){
+    char buff[256];
+    va_list vaList;
+    va_start(vaList, format);
+    int n = vsnprintf(buff, sizeof(buff), format, vaList);
+    va_end(vaList);
+    if(n < 0){
+        return;
+    }
+    if(static_cast<size_t>(n) < sizeof(buff)){
+        out.append(buff, n);
+        return;
+    }
+    size_t old = out.size();//宽度很大或者字符串很长时直接格式化到结果里
+    out.resize(old + n + 1);
+    va_start(vaList, format);
+    vsnprintf(&out[old], n + 1, format, vaList);
+    va_end(vaList);
+    out.resize(old + n);
+}
+}
+bool LogDecoder::ReadExact_(void* data, size_t len){
+    return len == 0 || fread(data, 1, len, fp_) == len;
+}
+bool LogDecoder::ReadHeader(){
+    char magic[sizeof(LOG_BINARY_MAGIC)];
+    return ReadExact_(magic, sizeof(magic)) && memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) == 0;
+}
+bool LogDecoder::ReadDescriptor_(){
+    char header[LOG_DESCRIPTOR_HEADER - 1];//类型字节已经读过
+    if(!ReadExact_(header, sizeof(header))){
+        return false;
+    }
+    uint32_t id;
+    uint16_t formatLen;
+    uint16_t fileLen;
+    Descriptor desc;
+    memcpy(&id, header, 4);
+    desc.level = static_cast<uint8_t>(header[4]);
+    desc.types.resize(static_cast<uint8_t>(header[5]));
+    memcpy(&desc.line, header + 6, 4);
+    memcpy(&formatLen, header + 10, 2);
+    memcpy(&fileLen, header + 12, 2);
+    desc.format.resize(formatLen);
+    desc.file.resize(fileLen);
+    if(!ReadExact_(desc.types.data(), desc.types.size()) || !ReadExact_(&desc.format[0], formatLen) ||
+       !ReadExact_(&desc.file[0], fileLen)){
+        return false;
+    }
+    descriptors_[id] = std::move(desc);//同一个id以最后的描述为准
+    return true;
+}
+void LogDecoder::AppendPrefix_(int64_t usec, int level, std::string& line){
+    struct timeval now;
+    now.tv_sec = usec / 1000000;
+    now.tv_usec = usec % 1000000;
+    char stamp[LogTimeCache::STAMP_LEN];
+    line.append(stamp, time_.Format(now, stamp));
+    line.append(LevelTitle(level));
+}
+bool LogDecoder::Format_(const Descriptor& desc, const char* payload, size_t len, std::string& line){
+    const char* format = desc.format.c_str();
+    const char* end = payload + len;
+    size_t arg = 0;
+    size_t pos = 0;
+    while(format[pos]){
+        if(format[pos] != '%'){
+            line.push_back(format[pos++]);
+            continue;
+        }
+        if(format[pos + 1] == '%'){
+            line.push_back('%');
+            pos += 2;
+            continue;
+        }
+        size_t start = pos;
+        char conversion = LogNextConversion(format, pos);
+        if(conversion == '?' || arg >= desc.types.size()){
+            return false;
+        }
+        //去掉长度修饰符，整数先截断到参数的宽度再统一按long long格式化
+        std::string spec;
+        size_t shorts = 0;
+        for(size_t i = start; i < pos - 1; i++){
+            if(format[i] == 'h'){
+                shorts++;
+            }else if(!strchr("lzjtLq", format[i])){
+                spec.push_back(format[i]);
+            }
+        }
+        uint8_t tag = desc.types[arg++];
+        uint8_t type = LogArgType(tag);
+        if(type == ARG_STRING){
+            uint16_t n;
+            if(end - payload < 2){
+                return false;
+            }
+            memcpy(&n, payload, 2);
+            if(end - payload - 2 < n){
+                return false;
+            }
+            std::string value(payload + 2, n);
+            payload += 2 + n;
+            spec.push_back('s');
+            AppendFormat(line, spec.c_str(), value.c_str());
+            continue;
+        }
+        if(end - payload < 8){
+            return false;
+        }
+        uint64_t raw;
+        memcpy(&raw, payload, 8);
+        payload += 8;
+        if(type == ARG_DOUBLE){
+            double value;
+            memcpy(&value, &raw, 8);
+            spec.push_back(conversion);
+            AppendFormat(line, spec.c_str(), value);
+        }else if(type == ARG_POINTER){
+            spec.push_back('p');
+            AppendFormat(line, spec.c_str(), reinterpret_cast<void*>(static_cast<uintptr_t>(raw)));
+        }else if(conversion == 'c'){
+            spec.push_back('c');
+            AppendFormat(line, spec.c_str(), static_cast<int>(raw));
+        }else{
+            //和printf一样，%hh和%h再截断到char和short
+            size_t width = shorts >= 2 ? 1 : shorts == 1 ? 2 : LogArgWidth(tag);
+            if(width < 8){
+                uint64_t mask = (1ull << (width * 8)) - 1;
+                raw &= mask;
+                if((conversion == 'd' || conversion == 'i') && (raw >> (width * 8 - 1))){
+                    raw |= ~mask;
+                }
+            }
+            spec += "ll";
+            spec.push_back(conversion);
+            if(conversion == 'd' || conversion == 'i'){
+                AppendFormat(line, spec.c_str(), static_cast<long long>(raw));
+            }else{
+                AppendFormat(line, spec.c_str(), static_cast<unsigned long long>(raw));
+            }
+        }
+    }
+    return true;
+}
+LogDecoder::DECODE_STATE LogDecoder::Next(std::string& line){
+    while(true){
+        int kind = fgetc(fp_);
+        if(kind == EOF){
+            return DECODE_END;
+        }
+        if(kind == RECORD_DESCRIPTOR){
+            if(!ReadDescriptor_()){
+                return DECODE_ERROR;
+            }
+            continue;
+        }
+        line.clear();
+        if(kind == RECORD_TEXT){
+            char header[LOG_TEXT_HEADER - 1];
+            if(!ReadExact_(header, sizeof(header))){
+                return DECODE_ERROR;
+            }
+            int64_t usec;
+            uint16_t len;
+            memcpy(&usec, header + 1, 8);
+            memcpy(&len, header + 9, 2);
+            payload_.resize(len);
+            if(!ReadExact_(payload_.data(), len)){
+                return DECODE_ERROR;
+            }
+            AppendPrefix_(usec, static_cast<uint8_t>(header[0]), line);
+            line.append(payload_.data(), len);
+            return DECODE_OK;
+        }
+        if(kind != RECORD_EVENT){
+            return DECODE_ERROR;
+        }
+        char header[LOG_EVENT_HEADER - 1];
+        if(!ReadExact_(header, sizeof(header))){
+            return DECODE_ERROR;
+        }
+        uint32_t id;
+        int64_t usec;
+        uint16_t len;
+        memcpy(&id, header, 4);
+        memcpy(&usec, header + 4, 8);
+        memcpy(&len, header + 12, 2);
+        payload_.resize(len);
+        if(!ReadExact_(payload_.data(), len)){
+            return DECODE_ERROR;
+        }
+        auto it = descriptors_.find(id);
+        if(it == descriptors_.end()){
+            return DECODE_ERROR;
+        }
+        AppendPrefix_(usec, it->second.level, line);
+        if(!Format_(it->second, payload_.data(), len, line)){
+            return DECODE_ERROR;
+        }
+        return DECODE_OK;
+    }
+}
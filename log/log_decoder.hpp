@@ -0,0 +1,81 @@
+/**
+ * @file log_decoder.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 二进制日志解码
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _LOG_DECODER_H_
+#define _LOG_DECODER_H_
+#include "binary_log.hpp"
+#include "log_time.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+/**
+ * @brief 把二进制日志文件还原成和文本模式相同格式的日志行
+ *
+ */
+class LogDecoder{
+    public:
+        enum DECODE_STATE{
+            DECODE_OK,
+            DECODE_END,//文件结束
+            DECODE_ERROR//文件头错误、记录不完整或者引用了没有描述的id
+        };
+        explicit LogDecoder(FILE* fp):fp_(fp){}
+        /**
+         * @brief 检查文件头，必须在第一次Next之前调用
+         *
+         * @return true
+         * @return false 不是二进制日志文件
+         */
+        bool ReadHeader();
+        /**
+         * @brief 解码下一条日志，格式描述记录会被跳过
+         *
+         * @param line 不带换行的日志行
+         * @return DECODE_STATE
+         */
+        DECODE_STATE Next(std::string& line);
+    private:
+        struct Descriptor{
+            int level = 0;
+            std::vector<uint8_t> types;
+            std::string format;
+            std::string file;
+            uint32_t line = 0;
+        };
+        bool ReadExact_(void* data, size_t len);
+        bool ReadDescriptor_();
+        /**
+         * @brief 写入时间戳和等级
+         *
+         * @param usec
+         * @param level
+         * @param line
+         */
+        void AppendPrefix_(int64_t usec, int level, std::string& line);
+        /**
+         * @brief 按格式描述格式化参数
+         *
+         * @param desc
+         * @param payload
+         * @param len
+         * @param line
+         * @return true
+         * @return false 参数和描述不一致
+         */
+        bool Format_(const Descriptor& desc, const char* payload, size_t len, std::string& line);
+        FILE* fp_;
+        std::unordered_map<uint32_t, Descriptor> descriptors_;
+        std::vector<char> payload_;
+        LogTimeCache time_;
+};
+#endif
@@ -0,0 +1,115 @@
+/**
+ * @file log_stage.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 每个线程的日志暂存区
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _LOG_STAGE_H_
+#define _LOG_STAGE_H_
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sys/uio.h>
+/**
+ * @brief 单生产者单消费者的字节环形缓冲区
+ * 生产者是写日志的线程，消费者是后台写线程；读写位置单调递增，两边各自只写一个位置，不需要加锁。
+ * 后台线程一次取走所有已提交的字节(环绕时分成两段)，和其他线程的暂存区一起用writev写出
+ */
+class LogStage{
+    public:
+        /**
+         * @brief 创建暂存区
+         *
+         * @param capacity 字节数，必须是2的幂
+         */
+        explicit LogStage(size_t capacity):data_(new char[capacity]),mask_(capacity - 1){
+            assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+        }
+        LogStage(const LogStage&) = delete;
+        LogStage& operator=(const LogStage&) = delete;
+        size_t Capacity() const{
+            return mask_ + 1;
+        }
+        /**
+         * @brief 生产者追加一条记录，空间不够时不写入
+         *
+         * @param data
+         * @param len 不能超过容量
+         * @return true
+         * @return false 空间不够
+         */
+        bool TryAppend(const char* data, size_t len){
+            assert(len <= Capacity());
+            uint64_t head = head_.load(std::memory_order_relaxed);
+            if(head + len - cached_tail_ > Capacity()){//缓存的读位置不够时才去读共享的位置
+                cached_tail_ = tail_.load(std::memory_order_acquire);
+                if(head + len - cached_tail_ > Capacity()){
+                    return false;
+                }
+            }
+            size_t pos = head & mask_;
+            size_t first = len < Capacity() - pos ? len : Capacity() - pos;
+            memcpy(data_.get() + pos, data, first);
+            memcpy(data_.get(), data + first, len - first);
+            head_.store(head + len, std::memory_order_release);
+            return true;
+        }
+        /**
+         * @brief 生产者看到的已用字节数
+         *
+         * @return size_t
+         */
+        size_t Used() const{
+            return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief 消费者取出所有已提交字节的位置
+         *
+         * @param iov 至少两个元素
+         * @param end 返回这次取到的结束位置，写完后传给Consume
+         * @return int iovec的个数
+         */
+        int GetReadIovec(iovec* iov, uint64_t* end) const{
+            uint64_t tail = tail_.load(std::memory_order_relaxed);
+            uint64_t head = head_.load(std::memory_order_acquire);
+            *end = head;
+            if(head == tail){
+                return 0;
+            }
+            size_t pos = tail & mask_;
+            size_t len = head - tail;
+            size_t first = len < Capacity() - pos ? len : Capacity() - pos;
+            iov[0].iov_base = data_.get() + pos;
+            iov[0].iov_len = first;
+            if(first == len){
+                return 1;
+            }
+            iov[1].iov_base = data_.get();
+            iov[1].iov_len = len - first;
+            return 2;
+        }
+        /**
+         * @brief 消费者释放写完的字节
+         *
+         * @param end
+         */
+        void Consume(uint64_t end){
+            tail_.store(end, std::memory_order_release);
+        }
+        std::atomic<bool> closed{false};//所属线程已经退出，写完剩余内容后可以删除
+        std::atomic<bool> wake_pending{false};//生产者已经唤醒过后台线程，后台线程处理后清除
+    private:
+        std::unique_ptr<char[]> data_;
+        const size_t mask_;
+        alignas(64) std::atomic<uint64_t> head_{0};//生产者写入的位置
+        uint64_t cached_tail_ = 0;//生产者缓存的读位置，减少跨核读取
+        alignas(64) std::atomic<uint64_t> tail_{0};//消费者读取的位置
+};
+#endif
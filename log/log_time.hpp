@@ -0,0 +1,88 @@
+/**
+ * @file log_time.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 日志时间戳缓存
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _LOG_TIME_H_
+#define _LOG_TIME_H_
+#include <cstring>
+#include <ctime>
+#include <sys/time.h>
+/**
+ * @brief 缓存格式化好的"YYYY-MM-DD HH:MM:SS."前缀
+ * 秒数变化时才调用localtime_r重新生成，同一秒内只把微秒写进去；不是线程安全的，每个线程一个
+ */
+class LogTimeCache{
+    public:
+        static const int PREFIX_LEN = 20;//"YYYY-MM-DD HH:MM:SS."
+        static const int STAMP_LEN = PREFIX_LEN + 7;//加上6位微秒和一个空格
+        /**
+         * @brief 更新到sec对应的时间，秒数没有变化时什么都不做
+         *
+         * @param sec
+         */
+        void Update(time_t sec){
+            if(sec == sec_){
+                return;
+            }
+            sec_ = sec;
+            localtime_r(&sec, &tm_);
+            int year = tm_.tm_year + 1900;
+            Put2_(prefix_, year / 100);
+            Put2_(prefix_ + 2, year % 100);
+            prefix_[4] = '-';
+            Put2_(prefix_ + 5, tm_.tm_mon + 1);
+            prefix_[7] = '-';
+            Put2_(prefix_ + 8, tm_.tm_mday);
+            prefix_[10] = ' ';
+            Put2_(prefix_ + 11, tm_.tm_hour);
+            prefix_[13] = ':';
+            Put2_(prefix_ + 14, tm_.tm_min);
+            prefix_[16] = ':';
+            Put2_(prefix_ + 17, tm_.tm_sec);
+            prefix_[19] = '.';
+        }
+        /**
+         * @brief 写入"YYYY-MM-DD HH:MM:SS.uuuuuu "
+         *
+         * @param now
+         * @param out 至少STAMP_LEN字节
+         * @return int 写入的字节数
+         */
+        int Format(const struct timeval& now, char* out){
+            Update(now.tv_sec);
+            memcpy(out, prefix_, PREFIX_LEN);
+            long usec = now.tv_usec;
+            Put2_(out + PREFIX_LEN, static_cast<int>(usec / 10000));
+            Put2_(out + PREFIX_LEN + 2, static_cast<int>(usec / 100 % 100));
+            Put2_(out + PREFIX_LEN + 4, static_cast<int>(usec % 100));
+            out[PREFIX_LEN + 6] = ' ';
+            return STAMP_LEN;
+        }
+        /**
+         * @brief 最近一次更新的本地时间
+         *
+         * @return const struct tm&
+         */
+        const struct tm& Tm() const{
+            return tm_;
+        }
+    private:
+        static void Put2_(char* out, int value){
+            static const char digits[] =
+                "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+                "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+                "8081828384858687888990919293949596979899";
+            memcpy(out, digits + value * 2, 2);
+        }
+        time_t sec_ = -1;
+        struct tm tm_;
+        char prefix_[PREFIX_LEN];
+};
+#endif
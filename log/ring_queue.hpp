@@ -0,0 +1,373 @@
+/**
+ * @file ring_queue.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 有界无锁多生产者多消费者环形队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _RING_QUEUE_H_
+#define _RING_QUEUE_H_
+#include "../pool/futex.hpp"
+#include <assert.h>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+/**
+ * @brief 有界无锁MPMC环形队列，可以替换BlockQueue
+ * 每个槽有一个序号，生产者和消费者各自用CAS推进位置(Vyukov算法)，入队出队都不加锁。
+ * 提供三种用法：try_*只尝试一次；spin_*忙等直到成功；push_back/pop等阻塞版本先自旋，
+ * 队列确实为空或者满时才在futex上休眠，另一端只在有线程休眠时才调用唤醒。
+ * 带超时的pop和BlockQueue一样使用std::chrono::milliseconds
+ * @tparam T
+ */
+template<typename T>
+class RingQueue{
+    public:
+        /**
+         * @brief 创建队列
+         *
+         * @param MaxCapacity 容量，向上取整到2的幂
+         */
+        explicit RingQueue(size_t MaxCapacity);
+        ~RingQueue();
+        RingQueue(const RingQueue&) = delete;
+        RingQueue& operator=(const RingQueue&) = delete;
+        /**
+         * @brief 尝试原地构造一个元素
+         *
+         * @return true
+         * @return false 队列已满
+         */
+        template<typename... Args>
+        bool try_emplace(Args&&... args);
+        bool try_push(const T& item){
+            return try_emplace(item);
+        }
+        bool try_push(T&& item){
+            return try_emplace(std::move(item));
+        }
+        /**
+         * @brief 尝试取出一个元素
+         *
+         * @param item
+         * @return true
+         * @return false 队列为空
+         */
+        bool try_pop(T& item);
+        /**
+         * @brief 忙等直到放入，不休眠，适合消费者一定很快跟上的场景
+         *
+         * @param item
+         */
+        void spin_push(T&& item);
+        /**
+         * @brief 忙等直到取出，不休眠
+         *
+         * @param item
+         */
+        void spin_pop(T& item);
+        /**
+         * @brief 原地构造一个元素，队列满时等待
+         *
+         * @return true
+         * @return false 队列已经关闭
+         */
+        template<typename... Args>
+        bool emplace(Args&&... args);
+        bool push_back(const T& item){
+            return emplace(item);
+        }
+        bool push_back(T&& item){
+            return emplace(std::move(item));
+        }
+        /**
+         * @brief 取出一个元素，队列为空时等待
+         *
+         * @param item
+         * @return true
+         * @return false 队列已经关闭并且为空
+         */
+        bool pop(T& item);
+        /**
+         * @brief 取出一个元素，最多等待timeout
+         *
+         * @param item
+         * @param timeout
+         * @return true
+         * @return false 超时或者队列已经关闭并且为空
+         */
+        bool pop(T& item, std::chrono::milliseconds timeout);
+        /**
+         * @brief 关闭队列，唤醒所有等待的线程；之后不能再放入，剩余的元素还可以取出
+         *
+         */
+        void Close();
+        void clear();
+        bool empty() const{
+            return size() == 0;
+        }
+        bool full() const{
+            return size() >= capacity();
+        }
+        /**
+         * @brief 元素个数，并发修改时是近似值
+         *
+         * @return size_t
+         */
+        size_t size() const{
+            size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+            size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+            return tail > head ? tail - head : 0;
+        }
+        size_t capacity() const{
+            return mask_ + 1;
+        }
+        /**
+         * @brief 唤醒一个等待的消费者
+         *
+         */
+        void flush(){
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            Wake_(not_empty_, consumers_waiting_);
+        }
+    private:
+        struct Slot{
+            std::atomic<size_t> seq;
+            alignas(T) unsigned char storage[sizeof(T)];
+            T* Get(){
+                return std::launder(reinterpret_cast<T*>(storage));
+            }
+        };
+        static size_t RoundUp_(size_t n){
+            size_t cap = 2;
+            while(cap < n){
+                cap <<= 1;
+            }
+            return cap;
+        }
+        /**
+         * @brief 另一端有线程休眠时推进futex字并唤醒一个
+         *
+         */
+        static void Wake_(std::atomic<uint32_t>& word, std::atomic<int>& waiting){
+            if(waiting.load(std::memory_order_relaxed) > 0){
+                word.fetch_add(1, std::memory_order_release);
+                FutexWake(&word, 1);
+            }
+        }
+        /**
+         * @brief 在word上等待，调用前需要先读取word并登记waiting
+         *
+         * @param deadline 为空时一直等待
+         * @return false 超时
+         */
+        static bool Wait_(std::atomic<uint32_t>& word, uint32_t seq, const std::chrono::steady_clock::time_point* deadline){
+            if(!deadline){
+                FutexWait(&word, seq);
+                return true;
+            }
+            auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(*deadline - std::chrono::steady_clock::now());
+            if(left.count() <= 0){
+                return false;
+            }
+            struct timespec ts;
+            ts.tv_sec = left.count() / 1000000000;
+            ts.tv_nsec = left.count() % 1000000000;
+            FutexWait(&word, seq, &ts);
+            return true;
+        }
+        bool Pop_(T& item, const std::chrono::steady_clock::time_point* deadline);
+        static const int SPIN_COUNT = 64;//休眠之前的自旋次数
+        Slot* slots_;
+        const size_t mask_;
+        alignas(64) std::atomic<size_t> enqueue_pos_{0};
+        alignas(64) std::atomic<size_t> dequeue_pos_{0};
+        alignas(64) std::atomic<uint32_t> not_empty_{0};//消费者等待的futex字
+        std::atomic<int> consumers_waiting_{0};
+        alignas(64) std::atomic<uint32_t> not_full_{0};//生产者等待的futex字
+        std::atomic<int> producers_waiting_{0};
+        std::atomic<bool> closed_{false};
+};
+
+template<typename T>
+RingQueue<T>::RingQueue(size_t MaxCapacity):mask_(RoundUp_(MaxCapacity) - 1){
+    assert(MaxCapacity > 0);
+    slots_ = new Slot[mask_ + 1];
+    for(size_t i = 0; i <= mask_; i++){
+        slots_[i].seq.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+RingQueue<T>::~RingQueue(){
+    clear();
+    delete[] slots_;
+}
+
+template<typename T>
+template<typename... Args>
+bool RingQueue<T>::try_emplace(Args&&... args){
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while(true){
+        slot = &slots_[pos & mask_];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if(diff == 0){
+            if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        }else if(diff < 0){//槽还没有被消费，队列已满
+            return false;
+        }else{
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    new (slot->storage) T(std::forward<Args>(args)...);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    //这个元素在队头(放入前队列为空)时才唤醒消费者，之后的元素由取走前一个元素的线程接力唤醒，
+    //消费者还没运行时连续放入不会每次都做系统调用；fence和等待方的登记配对，避免丢失唤醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(dequeue_pos_.load(std::memory_order_relaxed) == pos){
+        Wake_(not_empty_, consumers_waiting_);
+    }
+    if(!full()){//还有空位，接力唤醒下一个等待的生产者
+        Wake_(not_full_, producers_waiting_);
+    }
+    return true;
+}
+
+template<typename T>
+bool RingQueue<T>::try_pop(T& item){
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    while(true){
+        slot = &slots_[pos & mask_];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if(diff == 0){
+            if(dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                break;
+            }
+        }else if(diff < 0){//槽还没有被写入，队列为空
+            return false;
+        }else{
+            pos = dequeue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+    T* value = slot->Get();
+    item = std::move(*value);
+    value->~T();
+    slot->seq.store(pos + mask_ + 1, std::memory_order_release);
+    //取出前队列是满的(空出的槽还没有被占用)时才唤醒生产者，和放入时对称
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(enqueue_pos_.load(std::memory_order_relaxed) == pos + mask_ + 1){
+        Wake_(not_full_, producers_waiting_);
+    }
+    if(!empty()){//还有元素，接力唤醒下一个等待的消费者
+        Wake_(not_empty_, consumers_waiting_);
+    }
+    return true;
+}
+
+template<typename T>
+void RingQueue<T>::spin_push(T&& item){
+    while(!try_push(std::move(item))){
+        std::this_thread::yield();
+    }
+}
+
+template<typename T>
+void RingQueue<T>::spin_pop(T& item){
+    while(!try_pop(item)){
+        std::this_thread::yield();
+    }
+}
+
+template<typename T>
+template<typename... Args>
+bool RingQueue<T>::emplace(Args&&... args){
+    for(int i = 0; ; i++){
+        if(closed_.load(std::memory_order_acquire)){
+            return false;
+        }
+        //参数在成功之前不会被移走，可以重复尝试
+        if(try_emplace(std::forward<Args>(args)...)){
+            return true;
+        }
+        if(i < SPIN_COUNT){
+            continue;
+        }
+        uint32_t seq = not_full_.load(std::memory_order_acquire);
+        producers_waiting_.fetch_add(1, std::memory_order_seq_cst);
+        if(!full() || closed_.load(std::memory_order_seq_cst)){
+            producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        Wait_(not_full_, seq, nullptr);
+        producers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+    }
+}
+
+template<typename T>
+bool RingQueue<T>::Pop_(T& item, const std::chrono::steady_clock::time_point* deadline){
+    for(int i = 0; ; i++){
+        if(try_pop(item)){
+            return true;
+        }
+        if(closed_.load(std::memory_order_acquire) && empty()){
+            return false;
+        }
+        if(i < SPIN_COUNT){
+            continue;
+        }
+        uint32_t seq = not_empty_.load(std::memory_order_acquire);
+        consumers_waiting_.fetch_add(1, std::memory_order_seq_cst);
+        if(!empty() || closed_.load(std::memory_order_seq_cst)){
+            consumers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        bool waited = Wait_(not_empty_, seq, deadline);
+        consumers_waiting_.fetch_sub(1, std::memory_order_relaxed);
+        if(!waited){
+            return try_pop(item);
+        }
+    }
+}
+
+template<typename T>
+bool RingQueue<T>::pop(T& item){
+    return Pop_(item, nullptr);
+}
+
+template<typename T>
+bool RingQueue<T>::pop(T& item, std::chrono::milliseconds timeout){
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    return Pop_(item, &deadline);
+}
+
+template<typename T>
+void RingQueue<T>::Close(){
+    closed_.store(true, std::memory_order_seq_cst);
+    not_empty_.fetch_add(1, std::memory_order_release);
+    not_full_.fetch_add(1, std::memory_order_release);
+    FutexWake(&not_empty_, INT_MAX);
+    FutexWake(&not_full_, INT_MAX);
+}
+
+template<typename T>
+void RingQueue<T>::clear(){
+    T item;
+    while(try_pop(item)){
+    }
+}
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file connection.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 事件循环管理的连接接口
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _CONNECTION_H_
+#define _CONNECTION_H_
+#include <cstdint>
+#include <netinet/in.h>
+class Reactor;
+/**
+ * @brief 连接的协议处理
+ * 事件循环负责accept、epoll、超时和关闭fd，连接只负责读写自己的缓冲和处理协议。
+ * 所有方法都在所属事件循环的线程上调用
+ */
+class Connection{
+    public:
+        Connection(Reactor* loop, int fd, const sockaddr_in& addr):loop_(loop),fd_(fd),addr_(addr),id_(0){}
+        virtual ~Connection() = default;
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+        /**
+         * @brief 套接字可读时调用，读取数据并处理完整的请求
+         *
+         * @param edge 边缘触发，需要一直读到EAGAIN
+         * @return true
+         * @return false 对端关闭或者出错，关闭连接
+         */
+        virtual bool OnRead(bool edge) = 0;
+        /**
+         * @brief 有待发送的数据时调用，尽量多地写出
+         *
+         * @return true
+         * @return false 出错，关闭连接
+         */
+        virtual bool OnWrite() = 0;
+        /**
+         * @brief 是否还有数据没有写出
+         *
+         * @return true
+         * @return false
+         */
+        virtual bool WantWrite() const = 0;
+        /**
+         * @brief 数据写完之后是否保持连接
+         *
+         * @return true
+         * @return false
+         */
+        virtual bool KeepAlive() const = 0;
+        int GetFd() const{
+            return fd_;
+        }
+        const sockaddr_in& GetAddr() const{
+            return addr_;
+        }
+        Reactor* GetLoop() const{
+            return loop_;
+        }
+        /**
+         * @brief 事件循环分配的连接编号，fd关闭后被新连接复用时编号不同；
+         * 线程池的工作完成后用(fd, id)回到事件循环，连接已经换了就忽略
+         *
+         * @return uint64_t 加入事件循环之前为0
+         */
+        uint64_t GetId() const{
+            return id_;
+        }
+    protected:
+        Reactor* loop_;
+        int fd_;
+        sockaddr_in addr_;
+    private:
+        friend class Reactor;
+        uint64_t id_;
+};
+#endif
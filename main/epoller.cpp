@@ -0,0 +1,35 @@
+#include "epoller.hpp"
+#include <unistd.h>
+Epoller::Epoller(int maxEvent):epollFd_(epoll_create1(EPOLL_CLOEXEC)),events_(maxEvent){
+    assert(epollFd_ >= 0 && events_.size() > 0);
+}
+Epoller::~Epoller(){
+    close(epollFd_);
+}
+bool Epoller::AddFd(int fd, uint32_t events){
+    if(fd < 0){
+        return false;
+    }
+    struct epoll_event ev = {0, {0}};
+    ev.data.fd = fd;
+    ev.events = events;
+    return epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+bool Epoller::ModFd(int fd, uint32_t events){
+    if(fd < 0){
+        return false;
+    }
+    struct epoll_event ev = {0, {0}};
+    ev.data.fd = fd;
+    ev.events = events;
+    return epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev) == 0;
+}
+bool Epoller::DelFd(int fd){
+    if(fd < 0){
+        return false;
+    }
+    return epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr) == 0;
+}
+int Epoller::Wait(int timeoutMs){
+    return epoll_wait(epollFd_, events_.data(), static_cast<int>(events_.size()), timeoutMs);
+}
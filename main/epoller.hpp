@@ -0,0 +1,50 @@
+/**
+ * @file epoller.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief epoll的封装
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _EPOLLER_H_
+#define _EPOLLER_H_
+#include <assert.h>
+#include <cstdint>
+#include <sys/epoll.h>
+#include <vector>
+/**
+ * @brief 每个事件循环一个epoll实例，只在所属线程使用
+ *
+ */
+class Epoller{
+    public:
+        explicit Epoller(int maxEvent = 1024);
+        ~Epoller();
+        Epoller(const Epoller&) = delete;
+        Epoller& operator=(const Epoller&) = delete;
+        bool AddFd(int fd, uint32_t events);
+        bool ModFd(int fd, uint32_t events);
+        bool DelFd(int fd);
+        /**
+         * @brief 等待事件
+         *
+         * @param timeoutMs 小于0表示一直等待
+         * @return int 就绪的事件数
+         */
+        int Wait(int timeoutMs = -1);
+        int GetEventFd(size_t i) const{
+            assert(i < events_.size());
+            return events_[i].data.fd;
+        }
+        uint32_t GetEvents(size_t i) const{
+            assert(i < events_.size());
+            return events_[i].events;
+        }
+    private:
+        int epollFd_;
+        std::vector<struct epoll_event> events_;
+};
+#endif
@@ -1,4 +1,37 @@
-
-int main(){
+#include "webserver.hpp"
+#include "../http/http_connection.hpp"
+#include <cstdlib>
+#include <signal.h>
+#include <unistd.h>
+namespace {
+WebServer* g_server = nullptr;
+void OnSignal(int){
+    if(g_server){
+        g_server->Stop();
+    }
+}
+}
+int main(int argc, char* argv[]){
+    ServerOptions options;
+    int opt;
+    while((opt = getopt(argc, argv, "p:t:m:o:w:r:")) != -1){
+        switch(opt){
+            case 'p': options.port = atoi(optarg); break;//端口
+            case 't': options.loop_threads = atoi(optarg); break;//事件循环线程数
+            case 'm': options.trig_mode = atoi(optarg); break;//触发模式
+            case 'o': options.timeout_ms = atoi(optarg); break;//空闲超时
+            case 'w': options.worker_threads = static_cast<size_t>(atoi(optarg)); break;//线程池线程数
+            case 'r': HttpConnection::SetSrcDir(optarg); break;//静态文件根目录
+            default: break;
+        }
+    }
+    WebServer server(options, [](Reactor* loop, int fd, const sockaddr_in& addr){
+        return std::unique_ptr<Connection>(new HttpConnection(loop, fd, addr));
+    });
+    g_server = &server;
+    signal(SIGINT, OnSignal);
+    signal(SIGTERM, OnSignal);
+    server.Start();
+    g_server = nullptr;
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,306 @@
+#include "reactor.hpp"
+#include "../log/log.hpp"
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+Reactor::Reactor(const ReactorOptions& options, const ConnectionFactory& factory, ThreadPool* workers)
+    :options_(options),factory_(factory),workers_(workers),sql_(nullptr),listenFd_(-1),
+    wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),idleFd_(open("/dev/null", O_RDONLY | O_CLOEXEC)),entries_(1024),nextId_(1),connCount_(0),acceptCount_(0),
+    owner_(std::thread::id()),stop_(false),pending_(false){
+    assert(factory_ && wakeFd_ >= 0);
+    connEvent_ = EPOLLRDHUP | (options_.conn_et ? static_cast<uint32_t>(EPOLLET) : 0u);
+    epoller_.AddFd(wakeFd_, EPOLLIN);
+    timer_.SetWakeUp([this]{ Wakeup_(); });
+}
+Reactor::~Reactor(){
+    for(size_t fd = 0; fd < entries_.size(); fd++){
+        if(entries_[fd].conn){
+            entries_[fd].conn.reset();
+            close(static_cast<int>(fd));
+        }
+    }
+    if(listenFd_ >= 0){
+        close(listenFd_);
+    }
+    if(idleFd_ >= 0){
+        close(idleFd_);
+    }
+    close(wakeFd_);
+}
+bool Reactor::Listen(){
+    if(options_.port > 65535 || options_.port < 1024){
+        LOG_ERROR("Port:%d error!", options_.port);
+        return false;
+    }
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(listenFd_ < 0){
+        LOG_ERROR("Create socket error!");
+        return false;
+    }
+    struct linger optLinger = {0, 0};
+    if(options_.open_linger){//优雅关闭：直到所剩数据发送完毕或超时
+        optLinger.l_onoff = 1;
+        optLinger.l_linger = 1;
+    }
+    int optval = 1;
+    //每个事件循环绑定同一个端口，内核按四元组哈希把新连接分给各个监听socket
+    if(setsockopt(listenFd_, SOL_SOCKET, SO_LINGER, &optLinger, sizeof(optLinger)) < 0 ||
+       setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0 ||
+       setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0){
+        LOG_ERROR("Set socket option error!");
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    struct sockaddr_in addr;
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(options_.port);
+    if(bind(listenFd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+       listen(listenFd_, SOMAXCONN) < 0 ||
+       !epoller_.AddFd(listenFd_, EPOLLIN | (options_.listen_et ? static_cast<uint32_t>(EPOLLET) : 0u))){
+        LOG_ERROR("Bind or listen port:%d error!", options_.port);
+        close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    return true;
+}
+void Reactor::Loop(){
+    owner_.store(std::this_thread::get_id(), std::memory_order_relaxed);
+    timer_.BindThread();
+    if(options_.cpu >= 0){
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(options_.cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if(err != 0){
+            LOG_WARN("Bind loop thread to cpu %d error: %s", options_.cpu, strerror(err));
+        }
+    }
+    if(options_.arena_chunks > 0){//绑定之后再由本线程申请并写入，页面落在本地节点
+        SlabPool::Local().Reserve(options_.arena_chunks);
+    }
+    Drain_();
+    while(!stop_.load(std::memory_order_acquire)){
+        int timeout = timer_.GetNextTick();
+        int n = epoller_.Wait(timeout);
+        timer_.Refresh();
+        for(int i = 0; i < n; i++){
+            int fd = epoller_.GetEventFd(i);
+            uint32_t events = epoller_.GetEvents(i);
+            if(fd == listenFd_){
+                Accept_();
+                continue;
+            }
+            if(fd == wakeFd_){
+                uint64_t count;
+                ssize_t len = read(wakeFd_, &count, sizeof(count));
+                (void)len;
+                Drain_();
+                continue;
+            }
+            //回调里可能打开新的fd让entries_扩容，这里不持有Entry的引用，回调之后都按fd重新取
+            const Entry& entry = GetEntry_(fd);
+            if(entry.handler){
+                Functor handler = entry.handler;//entries_扩容会移动正在执行的回调，先复制一份
+                handler();
+            }else if(!entry.conn){
+                continue;//同一批事件里已经被关闭
+            }else if(events & (EPOLLHUP | EPOLLERR)){
+                CloseConn(fd);
+            }else if(events & (EPOLLIN | EPOLLRDHUP)){//对端半关闭时读到0再关闭
+                HandleRead_(fd);
+            }else if(events & EPOLLOUT){
+                HandleWrite_(fd);
+            }
+        }
+    }
+    for(size_t fd = 0; fd < entries_.size(); fd++){
+        if(entries_[fd].conn){
+            CloseConn(static_cast<int>(fd));
+        }
+    }
+}
+void Reactor::Stop(){
+    stop_.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    ssize_t len = write(wakeFd_, &one, sizeof(one));
+    (void)len;
+}
+void Reactor::RunInLoop(Functor func){
+    if(InLoopThread()){
+        func();
+        return;
+    }
+    functors_.Push(std::move(func));
+    //入队之后再设置标记，事件循环清除标记之后入队的函数一定会再唤醒一次
+    if(!pending_.exchange(true, std::memory_order_acq_rel)){
+        Wakeup_();
+    }
+}
+void Reactor::RunInLoop(int fd, uint64_t id, Functor func){
+    RunInLoop([this, fd, id, func = std::move(func)]{
+        if(IsAlive_(fd, id)){
+            func();
+        }
+    });
+}
+void Reactor::Wakeup_(){
+    uint64_t one = 1;
+    ssize_t len = write(wakeFd_, &one, sizeof(one));
+    (void)len;
+}
+void Reactor::Drain_(){
+    if(!pending_.load(std::memory_order_acquire)){
+        return;
+    }
+    pending_.store(false, std::memory_order_seq_cst);
+    Functor func;
+    while(functors_.Pop(func)){
+        func();
+    }
+}
+Reactor::Entry& Reactor::GetEntry_(int fd){
+    if(static_cast<size_t>(fd) >= entries_.size()){
+        entries_.resize(static_cast<size_t>(fd) * 2);
+    }
+    return entries_[fd];
+}
+void Reactor::Accept_(){
+    do{
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listenFd_, reinterpret_cast<struct sockaddr*>(&addr), &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0){
+            if(errno == EINTR || errno == ECONNABORTED){
+                continue;
+            }
+            if((errno == EMFILE || errno == ENFILE) && idleFd_ >= 0){
+                //fd用完时连接留在队列里，边缘触发不会再通知；临时释放预留的fd，接受并关闭这个连接，再把fd占回来
+                LOG_WARN("Accept error: too many open files!");
+                close(idleFd_);
+                fd = accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if(fd >= 0){
+                    close(fd);
+                }
+                idleFd_ = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                if(fd >= 0){
+                    continue;
+                }
+            }
+            return;
+        }
+        if(connCount_.load(std::memory_order_relaxed) >= static_cast<size_t>(options_.max_conns)){
+            const char* info = "Server busy!";
+            ssize_t n = send(fd, info, strlen(info), MSG_NOSIGNAL);
+            (void)n;
+            close(fd);
+            LOG_WARN("Clients is full!");
+            continue;
+        }
+        AddConn_(fd, addr);
+    }while(options_.listen_et);
+}
+uint64_t Reactor::AddConn_(int fd, const sockaddr_in& addr){
+    int optval = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &optval, sizeof(optval));//小响应不等待合并
+    std::unique_ptr<Connection> conn = factory_(this, fd, addr);
+    Entry& entry = GetEntry_(fd);//工厂里可能打开其他fd，创建之后再取Entry
+    entry.conn = std::move(conn);
+    entry.writing = false;
+    entry.id = 0;
+    if(!entry.conn || !epoller_.AddFd(fd, EPOLLIN | connEvent_)){
+        entry.conn.reset();
+        close(fd);
+        return 0;
+    }
+    entry.id = nextId_++;
+    entry.conn->id_ = entry.id;
+    connCount_.fetch_add(1, std::memory_order_relaxed);
+    acceptCount_.fetch_add(1, std::memory_order_relaxed);
+    if(options_.timeout_ms > 0){
+        timer_.add(fd, options_.timeout_ms, [this, fd]{ CloseConn(fd); });
+    }
+    return entry.id;
+}
+bool Reactor::IsAlive_(int fd, uint64_t id){
+    const Entry& entry = GetEntry_(fd);
+    return entry.conn && entry.id == id;
+}
+void Reactor::CloseConn(int fd){
+    assert(InLoopThread());
+    Entry& entry = GetEntry_(fd);
+    if(!entry.conn){
+        return;
+    }
+    timer_.cancel(fd);
+    epoller_.DelFd(fd);
+    entry.conn.reset();
+    entry.writing = false;
+    entry.id = 0;
+    close(fd);
+    connCount_.fetch_sub(1, std::memory_order_relaxed);
+}
+void Reactor::HandleRead_(int fd){
+    if(options_.timeout_ms > 0){
+        timer_.adjust(fd, options_.timeout_ms);
+    }
+    if(!entries_[fd].conn->OnRead(options_.conn_et)){
+        CloseConn(fd);
+        return;
+    }
+    Flush_(fd);
+}
+void Reactor::HandleWrite_(int fd){
+    if(options_.timeout_ms > 0){
+        timer_.adjust(fd, options_.timeout_ms);
+    }
+    Flush_(fd);
+}
+void Reactor::Flush_(int fd){
+    Connection* conn = entries_[fd].conn.get();
+    if(conn->WantWrite() && !conn->OnWrite()){
+        CloseConn(fd);
+        return;
+    }
+    Entry& entry = entries_[fd];//OnWrite之后重新取
+    if(conn->WantWrite()){//内核缓冲满了，等可写
+        if(!entry.writing){
+            epoller_.ModFd(fd, EPOLLOUT | connEvent_);
+            entry.writing = true;
+        }
+        return;
+    }
+    if(!conn->KeepAlive()){
+        CloseConn(fd);
+        return;
+    }
+    if(entry.writing){
+        epoller_.ModFd(fd, EPOLLIN | connEvent_);
+        entry.writing = false;
+    }
+}
+void Reactor::Update(int fd, uint64_t id){
+    assert(InLoopThread());
+    if(IsAlive_(fd, id)){
+        Flush_(fd);
+    }
+}
+void Reactor::Watch(int fd, uint32_t events, Functor handler){
+    assert(InLoopThread() || owner_.load(std::memory_order_relaxed) == std::thread::id());
+    GetEntry_(fd).handler = std::move(handler);
+    epoller_.AddFd(fd, events);
+}
+void Reactor::Unwatch(int fd){
+    epoller_.DelFd(fd);
+    GetEntry_(fd).handler = nullptr;
+}
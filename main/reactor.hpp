@@ -0,0 +1,203 @@
+/**
+ * @file reactor.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 每个线程一个的事件循环
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _REACTOR_H_
+#define _REACTOR_H_
+#include "connection.hpp"
+#include "epoller.hpp"
+#include "../buffer/slab_pool.hpp"
+#include "../pool/thread_pool.hpp"
+#include "../timer/loop_timer.hpp"
+#include "../timer/mpsc_queue.hpp"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+class AsyncSqlConnPool;
+/**
+ * @brief 事件循环的配置
+ *
+ */
+struct ReactorOptions{
+    int port = 1316;
+    bool listen_et = true;//监听socket边缘触发
+    bool conn_et = true;//连接边缘触发
+    int timeout_ms = 60000;//连接空闲超时，0表示不超时
+    bool open_linger = false;//关闭时等待数据发送完毕
+    int max_conns = 65536;//这个事件循环的最大连接数
+    int cpu = -1;//绑定的CPU，小于0表示不绑定
+    size_t arena_chunks = 0;//启动时在本线程预留的缓冲块数，连接的读写缓冲从这里取
+};
+/**
+ * @brief 主从一体的事件循环，每个线程一个
+ * 每个事件循环用SO_REUSEPORT打开自己的监听socket，由内核把新连接分到各个循环；
+ * 连接的accept、读写、定时器和关闭都在同一个线程完成，不跨线程、不加锁。
+ * 阻塞的工作(比如同步数据库调用)交给线程池，完成后用RunInLoop回到所属的事件循环
+ */
+class Reactor{
+    public:
+        typedef std::function<void()> Functor;
+        typedef std::function<std::unique_ptr<Connection>(Reactor* loop, int fd, const sockaddr_in& addr)> ConnectionFactory;
+        /**
+         * @brief 创建事件循环
+         *
+         * @param options
+         * @param factory 为每个新连接创建协议处理
+         * @param workers 处理阻塞工作的线程池，可以为空
+         */
+        Reactor(const ReactorOptions& options, const ConnectionFactory& factory, ThreadPool* workers);
+        ~Reactor();
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+        /**
+         * @brief 打开监听socket，在启动线程调用
+         *
+         * @return true
+         * @return false 创建、绑定或者监听失败
+         */
+        bool Listen();
+        /**
+         * @brief 运行事件循环直到Stop，在事件循环线程调用
+         *
+         */
+        void Loop();
+        /**
+         * @brief 让事件循环退出，可以在任意线程和信号处理函数里调用
+         *
+         */
+        void Stop();
+        /**
+         * @brief 在事件循环线程上执行func，可以在任意线程调用
+         *
+         * @param func
+         */
+        void RunInLoop(Functor func);
+        /**
+         * @brief 在事件循环线程上执行连接的后续工作，可以在任意线程调用
+         * 执行前连接已经关闭或者fd已经被新连接复用时不执行
+         *
+         * @param fd
+         * @param id 连接的GetId()
+         * @param func
+         */
+        void RunInLoop(int fd, uint64_t id, Functor func);
+        bool InLoopThread() const{
+            return owner_.load(std::memory_order_relaxed) == std::this_thread::get_id();
+        }
+        /**
+         * @brief 连接在事件回调之外(比如线程池的工作完成后)产生了要发送的数据，重新检查它的读写状态
+         * 只能在事件循环线程调用，连接已经关闭或者fd已经被新连接复用时忽略
+         *
+         * @param fd
+         * @param id 连接的GetId()
+         */
+        void Update(int fd, uint64_t id);
+        /**
+         * @brief 关闭连接，只能在事件循环线程调用
+         *
+         * @param fd
+         */
+        void CloseConn(int fd);
+        /**
+         * @brief 监听连接以外的fd，比如异步数据库连接池，只能在事件循环线程调用
+         *
+         * @param fd
+         * @param events
+         * @param handler 就绪时调用
+         */
+        void Watch(int fd, uint32_t events, Functor handler);
+        void Unwatch(int fd);
+        LoopTimer<HeapTimer>& Timer(){
+            return timer_;
+        }
+        ThreadPool* Workers() const{
+            return workers_;
+        }
+        /**
+         * @brief 这个事件循环的异步数据库连接池，没有配置时为空
+         *
+         * @return AsyncSqlConnPool*
+         */
+        AsyncSqlConnPool* AsyncSql() const{
+            return sql_;
+        }
+        void SetAsyncSql(AsyncSqlConnPool* sql){
+            sql_ = sql;
+        }
+        size_t ConnectionCount() const{
+            return connCount_.load(std::memory_order_relaxed);
+        }
+        uint64_t AcceptCount() const{
+            return acceptCount_.load(std::memory_order_relaxed);
+        }
+    private:
+        struct Entry{
+            std::unique_ptr<Connection> conn;
+            Functor handler;//Watch的回调
+            bool writing = false;//正在等待可写
+            uint64_t id = 0;//连接的编号，0表示没有连接
+        };
+        void Accept_();
+        /**
+         * @brief 创建连接并加入epoll
+         *
+         * @param fd
+         * @param addr
+         * @return uint64_t 分配的连接编号，失败时返回0
+         */
+        uint64_t AddConn_(int fd, const sockaddr_in& addr);
+        /**
+         * @brief fd上还是编号为id的连接
+         *
+         */
+        bool IsAlive_(int fd, uint64_t id);
+        /**
+         * @brief 连接的回调可能让entries_扩容，这几个函数只传fd，回调之后重新取Entry
+         *
+         * @param fd
+         */
+        void HandleRead_(int fd);
+        void HandleWrite_(int fd);
+        /**
+         * @brief 写出待发送的数据，按结果切换关注的事件或者关闭连接
+         *
+         * @param fd
+         */
+        void Flush_(int fd);
+        void Wakeup_();
+        /**
+         * @brief 执行其他线程提交的函数
+         *
+         */
+        void Drain_();
+        Entry& GetEntry_(int fd);
+        ReactorOptions options_;
+        ConnectionFactory factory_;
+        ThreadPool* workers_;
+        AsyncSqlConnPool* sql_;
+        Epoller epoller_;
+        LoopTimer<HeapTimer> timer_;
+        int listenFd_;
+        int wakeFd_;
+        int idleFd_;//预留的fd，fd用完时临时释放，用来接受并关闭积压的连接
+        uint32_t connEvent_;//连接关注的基本事件
+        std::vector<Entry> entries_;//按fd下标
+        uint64_t nextId_;//下一个连接的编号，只在事件循环线程使用
+        std::atomic<size_t> connCount_;
+        std::atomic<uint64_t> acceptCount_;
+        std::atomic<std::thread::id> owner_;
+        std::atomic<bool> stop_;
+        MpscQueue<Functor> functors_;
+        alignas(64) std::atomic<bool> pending_;//有未执行的跨线程函数
+};
+#endif
@@ -0,0 +1,92 @@
+#include "webserver.hpp"
+#include "../pool/sql_connection_pool.hpp"
+#include <signal.h>
+#include <utility>
+WebServer::WebServer(const ServerOptions& options, const Reactor::ConnectionFactory& factory)
+    :options_(options),ready_(true){
+    signal(SIGPIPE, SIG_IGN);//对端关闭后写入返回EPIPE，不让进程退出
+    if(options_.open_log){
+        Log::Instance()->init(options_.log_level, "./log", ".log", options_.log_queue_size);
+    }
+    size_t loopCount = options_.loop_threads > 0 ? options_.loop_threads : std::thread::hardware_concurrency();
+    if(loopCount == 0){
+        loopCount = 1;
+    }
+    workers_.reset(new ThreadPool(options_.worker_threads > 0 ? options_.worker_threads : 1));
+    if(!options_.db_name.empty() && options_.sql_conns > 0){
+        SqlConnPool::Instance()->Init(options_.sql_host.c_str(), options_.sql_port, options_.sql_user.c_str(),
+                                      options_.sql_pwd.c_str(), options_.db_name.c_str(), options_.sql_conns);
+    }
+    ReactorOptions loopOptions;
+    loopOptions.port = options_.port;
+    loopOptions.listen_et = options_.trig_mode & 2;
+    loopOptions.conn_et = options_.trig_mode & 1;
+    loopOptions.timeout_ms = options_.timeout_ms;
+    loopOptions.open_linger = options_.open_linger;
+    loopOptions.arena_chunks = options_.arena_chunks;
+    loopOptions.max_conns = options_.max_conns / static_cast<int>(loopCount) + 1;
+    for(size_t i = 0; i < loopCount; i++){
+        loopOptions.cpu = options_.pin_cpu ? ThreadPool::AllowedCpu(i) : -1;//和工作线程一样只在进程允许的CPU里选
+        std::unique_ptr<Reactor> loop(new Reactor(loopOptions, factory, workers_.get()));
+        if(!loop->Listen()){
+            ready_ = false;
+        }
+        if(!options_.db_name.empty() && options_.async_sql_conns > 0){
+            std::unique_ptr<AsyncSqlConnPool> sql(new AsyncSqlConnPool());
+            if(sql->Init(options_.sql_host.c_str(), options_.sql_port, options_.sql_user.c_str(),
+                         options_.sql_pwd.c_str(), options_.db_name.c_str(), options_.async_sql_conns)){
+                loop->SetAsyncSql(sql.get());
+                sqls_.push_back(std::move(sql));
+            }
+        }
+        loops_.push_back(std::move(loop));
+    }
+    if(ready_){
+        LOG_INFO("========== Server init ==========");
+        LOG_INFO("Port:%d, OpenLinger: %s", options_.port, options_.open_linger ? "true" : "false");
+        LOG_INFO("Listen Mode: %s, OpenConn Mode: %s", (options_.trig_mode & 2) ? "ET" : "LT", (options_.trig_mode & 1) ? "ET" : "LT");
+        LOG_INFO("Loop threads: %zu, worker threads: %zu", loops_.size(), workers_->ThreadCount());
+    }else{
+        LOG_ERROR("========== Server init error!==========");
+    }
+}
+WebServer::~WebServer(){
+    Stop();
+    for(auto& thread : threads_){
+        if(thread.joinable()){
+            thread.join();
+        }
+    }
+    loops_.clear();
+    sqls_.clear();
+    workers_.reset();
+    if(!options_.db_name.empty() && options_.sql_conns > 0){
+        SqlConnPool::Instance()->ClosePool();
+    }
+}
+void WebServer::Start(){
+    if(!ready_){
+        return;
+    }
+    LOG_INFO("========== Server start ==========");
+    for(size_t i = 0; i < loops_.size(); i++){
+        Reactor* loop = loops_[i].get();
+        AsyncSqlConnPool* sql = loop->AsyncSql();
+        threads_.emplace_back([loop, sql]{
+            if(sql){//异步连接池只由它所在的事件循环操作
+                sql->BindThread();
+                loop->Watch(sql->Fd(), EPOLLIN, [sql]{ sql->HandleEvents(); });
+            }
+            loop->Loop();
+        });
+    }
+    for(auto& thread : threads_){
+        thread.join();
+    }
+    threads_.clear();
+}
+void WebServer::Stop(){
+    for(auto& loop : loops_){
+        loop->Stop();
+    }
+}
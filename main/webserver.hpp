@@ -0,0 +1,91 @@
+/**
+ * @file webserver.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 多事件循环的服务器
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _WEBSERVER_H_
+#define _WEBSERVER_H_
+#include "reactor.hpp"
+#include "../log/log.hpp"
+#include "../pool/async_sql_pool.hpp"
+#include "../pool/thread_pool.hpp"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+/**
+ * @brief 服务器的配置
+ *
+ */
+struct ServerOptions{
+    int port = 1316;
+    int trig_mode = 3;//0:监听和连接都是水平触发 1:连接边缘触发 2:监听边缘触发 3:都是边缘触发
+    int timeout_ms = 60000;//连接空闲超时，0表示不超时
+    bool open_linger = false;
+    int loop_threads = 0;//事件循环线程数，0表示每个CPU一个
+    bool pin_cpu = false;//把每个事件循环绑定到一个CPU
+    size_t arena_chunks = SlabPool::LOCAL_CACHE_MAX;//每个事件循环预留的缓冲块数
+    int max_conns = 65536;//所有事件循环的最大连接数之和
+    size_t worker_threads = 4;//处理阻塞工作的线程池线程数
+    std::string sql_host = "localhost";
+    int sql_port = 3306;
+    std::string sql_user = "root";
+    std::string sql_pwd;
+    std::string db_name;//为空时不连接数据库
+    int sql_conns = 0;//线程池使用的同步连接数
+    int async_sql_conns = 0;//每个事件循环的异步连接数
+    bool open_log = true;
+    int log_level = INFO;
+    int log_queue_size = 1024;
+};
+/**
+ * @brief 服务器
+ * 每个CPU一个事件循环线程，各自用SO_REUSEPORT监听同一个端口，拥有自己的连接和定时器，
+ * 新连接的accept和之后的所有读写都不跨线程；线程池只用来执行阻塞的工作
+ */
+class WebServer{
+    public:
+        /**
+         * @brief 创建服务器，打开日志、数据库连接和所有监听socket
+         *
+         * @param options
+         * @param factory 为每个新连接创建协议处理
+         */
+        WebServer(const ServerOptions& options, const Reactor::ConnectionFactory& factory);
+        ~WebServer();
+        WebServer(const WebServer&) = delete;
+        WebServer& operator=(const WebServer&) = delete;
+        /**
+         * @brief 启动所有事件循环并等待它们退出
+         *
+         */
+        void Start();
+        /**
+         * @brief 让所有事件循环退出，可以在任意线程和信号处理函数里调用
+         *
+         */
+        void Stop();
+        bool IsReady() const{
+            return ready_;
+        }
+        ThreadPool& Workers(){
+            return *workers_;
+        }
+        size_t LoopCount() const{
+            return loops_.size();
+        }
+    private:
+        ServerOptions options_;
+        bool ready_;//所有监听socket都已经打开
+        std::unique_ptr<ThreadPool> workers_;
+        std::vector<std::unique_ptr<Reactor>> loops_;
+        std::vector<std::unique_ptr<AsyncSqlConnPool>> sqls_;
+        std::vector<std::thread> threads_;
+};
+#endif
@@ -0,0 +1,396 @@
+#include "async_sql_pool.hpp"
+#include "../log/log.hpp"
+#include <mysql/errmsg.h>
+#include <assert.h>
+#include <cerrno>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <utility>
+namespace {
+/**
+ * @brief 和timerfd相同的时钟，单位毫秒
+ *
+ */
+int64_t NowMs(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+bool ConnectionLost(unsigned int err){
+    return err == CR_SERVER_GONE_ERROR || err == CR_SERVER_LOST || err == CR_CONNECTION_ERROR;
+}
+}
+AsyncSqlConnPool::AsyncSqlConnPool():port_(0),epollFd_(-1),wakeFd_(-1),timerFd_(-1),timerDeadline_(0),
+    owner_(std::this_thread::get_id()),pending_(false){
+}
+AsyncSqlConnPool::~AsyncSqlConnPool(){
+    ClosePool();
+}
+bool AsyncSqlConnPool::Init(const char* host, int port, const char* user, const char* pwd, const char* db, int conn_size){
+    assert(conn_size > 0);
+    host_ = host;
+    port_ = port;
+    user_ = user;
+    pwd_ = pwd;
+    db_ = db;
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    timerFd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(epollFd_ < 0 || wakeFd_ < 0 || timerFd_ < 0){
+        LOG_ERROR("AsyncSqlConnPool init error!");
+        return false;
+    }
+    struct epoll_event ev = {0, {0}};
+    ev.events = EPOLLIN;
+    ev.data.u64 = WAKE_ID;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    ev.data.u64 = TIMER_ID;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, timerFd_, &ev);
+    for(int i = 0; i < conn_size; i++){
+        std::unique_ptr<Conn> conn(new Conn());
+        conn->index = conns_.size();
+        conn->sql = mysql_init(nullptr);
+        if(!conn->sql){
+            LOG_ERROR("Mysql init error!");
+            assert(conn->sql);
+        }
+        mysql_options(conn->sql, MYSQL_OPT_NONBLOCK, 0);
+        //启动时同步连接，开启非阻塞之后阻塞接口仍然可以使用
+        if(!mysql_real_connect(conn->sql, host_.c_str(), user_.c_str(), pwd_.c_str(), db_.c_str(), port_, nullptr, 0)){
+            LOG_ERROR("Mysql connect error: %s", mysql_error(conn->sql));
+            conn->state = CONN_BROKEN;
+            conn->deadline = NowMs() + RECONNECT_MS;
+        }else{
+            free_.push_back(conn.get());
+        }
+        conns_.push_back(std::move(conn));
+    }
+    RearmTimer_();
+    return true;
+}
+void AsyncSqlConnPool::Query(std::string sql, QueryCallBack call_back){
+    Request request{std::move(sql), std::move(call_back)};
+    if(InLoopThread()){
+        Dispatch_(std::move(request));
+        return;
+    }
+    requests_.Push(std::move(request));
+    //入队之后再设置标记，所属线程清除标记之后入队的查询一定会再唤醒一次
+    if(!pending_.exchange(true, std::memory_order_acq_rel)){
+        uint64_t one = 1;
+        ssize_t n = write(wakeFd_, &one, sizeof(one));
+        (void)n;
+    }
+}
+void AsyncSqlConnPool::Drain_(){
+    if(!pending_.load(std::memory_order_acquire)){
+        return;
+    }
+    pending_.store(false, std::memory_order_seq_cst);
+    Request request;
+    while(requests_.Pop(request)){
+        Dispatch_(std::move(request));
+    }
+}
+void AsyncSqlConnPool::Dispatch_(Request&& request){
+    if(free_.empty()){
+        waiting_.push_back(std::move(request));
+        return;
+    }
+    Conn* conn = free_.back();
+    free_.pop_back();
+    conn->request = std::move(request);
+    StartQuery_(conn);
+}
+void AsyncSqlConnPool::StartQuery_(Conn* conn){
+    conn->state = CONN_QUERY;
+    int err = 0;
+    int status = mysql_real_query_start(&err, conn->sql, conn->request.sql.data(), conn->request.sql.size());
+    if(status){
+        Wait_(conn, status);
+        return;
+    }
+    QueryDone_(conn, err);
+}
+void AsyncSqlConnPool::QueryDone_(Conn* conn, int err){
+    if(err){
+        Finish_(conn, nullptr);
+        return;
+    }
+    conn->state = CONN_STORE;
+    MYSQL_RES* res = nullptr;
+    int status = mysql_store_result_start(&res, conn->sql);
+    if(status){
+        Wait_(conn, status);
+        return;
+    }
+    Finish_(conn, res);
+}
+void AsyncSqlConnPool::Finish_(Conn* conn, MYSQL_RES* res){
+    AsyncSqlResult result;
+    result.err = mysql_errno(conn->sql);
+    if(result.err){
+        result.error = mysql_error(conn->sql);
+    }else if(!res){
+        result.affected_rows = mysql_affected_rows(conn->sql);
+        result.insert_id = mysql_insert_id(conn->sql);
+    }
+    result.res = res;
+    Request request = std::move(conn->request);
+    //先释放连接，回调里提交的查询可以直接使用；store_result的结果不依赖连接
+    if(ConnectionLost(result.err)){
+        Reconnect_(conn);
+    }else{
+        Release_(conn);
+    }
+    if(request.call_back){
+        request.call_back(result);
+    }
+    if(res){
+        mysql_free_result(res);
+    }
+}
+void AsyncSqlConnPool::Release_(Conn* conn){
+    conn->state = CONN_IDLE;
+    conn->deadline = 0;
+    if(waiting_.empty()){
+        free_.push_back(conn);
+        return;
+    }
+    conn->request = std::move(waiting_.front());
+    waiting_.pop_front();
+    StartQuery_(conn);
+}
+void AsyncSqlConnPool::Reconnect_(Conn* conn){
+    if(conn->fd >= 0){
+        epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+        conn->fd = -1;
+    }
+    if(conn->sql){
+        //mysql_close会发送COM_QUIT，对端没有响应时会阻塞事件循环，所以也用非阻塞接口
+        conn->state = CONN_CLOSE;
+        int status = mysql_close_start(conn->sql);
+        if(status){
+            Wait_(conn, status);
+            return;
+        }
+        conn->sql = nullptr;
+    }
+    Connect_(conn);
+}
+void AsyncSqlConnPool::Connect_(Conn* conn){
+    conn->sql = mysql_init(nullptr);
+    if(!conn->sql){
+        LOG_ERROR("Mysql init error!");
+        conn->state = CONN_BROKEN;
+        conn->deadline = NowMs() + RECONNECT_MS;
+        RearmTimer_();
+        return;
+    }
+    mysql_options(conn->sql, MYSQL_OPT_NONBLOCK, 0);
+    conn->state = CONN_CONNECT;
+    MYSQL* ret = nullptr;
+    int status = mysql_real_connect_start(&ret, conn->sql, host_.c_str(), user_.c_str(), pwd_.c_str(), db_.c_str(),
+                                          port_, nullptr, 0);
+    if(status){
+        Wait_(conn, status);
+        return;
+    }
+    ConnectDone_(conn, ret);
+}
+void AsyncSqlConnPool::ConnectDone_(Conn* conn, MYSQL* ret){
+    if(!ret){
+        LOG_ERROR("Mysql reconnect error: %s", mysql_error(conn->sql));
+        if(conn->fd >= 0){
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+            conn->fd = -1;
+        }
+        conn->state = CONN_BROKEN;
+        conn->deadline = NowMs() + RECONNECT_MS;
+        RearmTimer_();
+        return;
+    }
+    Release_(conn);
+}
+void AsyncSqlConnPool::Wait_(Conn* conn, int status){
+    struct epoll_event ev = {0, {0}};
+    if(status & MYSQL_WAIT_READ){
+        ev.events |= EPOLLIN;
+    }
+    if(status & MYSQL_WAIT_WRITE){
+        ev.events |= EPOLLOUT;
+    }
+    if(status & MYSQL_WAIT_EXCEPT){
+        ev.events |= EPOLLPRI;
+    }
+    ev.data.u64 = conn->index;
+    int fd = mysql_get_socket(conn->sql);
+    if(fd != conn->fd){//第一次等待或者重连之后socket变了
+        if(conn->fd >= 0){
+            epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+        }
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+        conn->fd = fd;
+    }else{
+        epoll_ctl(epollFd_, EPOLL_CTL_MOD, fd, &ev);
+    }
+    if(status & MYSQL_WAIT_TIMEOUT){
+        conn->deadline = NowMs() + mysql_get_timeout_value_ms(conn->sql);
+        RearmTimer_();
+    }else{
+        conn->deadline = 0;
+    }
+}
+void AsyncSqlConnPool::Continue_(Conn* conn, int status){
+    switch(conn->state){
+        case CONN_CLOSE:{
+            status = mysql_close_cont(conn->sql, status);
+            if(status){
+                Wait_(conn, status);
+                return;
+            }
+            conn->sql = nullptr;
+            conn->fd = -1;//socket关闭时已经从epoll里移除
+            Connect_(conn);
+            return;
+        }
+        case CONN_CONNECT:{
+            MYSQL* ret = nullptr;
+            status = mysql_real_connect_cont(&ret, conn->sql, status);
+            if(status){
+                Wait_(conn, status);
+                return;
+            }
+            ConnectDone_(conn, ret);
+            return;
+        }
+        case CONN_QUERY:{
+            int err = 0;
+            status = mysql_real_query_cont(&err, conn->sql, status);
+            if(status){
+                Wait_(conn, status);
+                return;
+            }
+            QueryDone_(conn, err);
+            return;
+        }
+        case CONN_STORE:{
+            MYSQL_RES* res = nullptr;
+            status = mysql_store_result_cont(&res, conn->sql, status);
+            if(status){
+                Wait_(conn, status);
+                return;
+            }
+            Finish_(conn, res);
+            return;
+        }
+        default://空闲连接上的事件(比如服务器关闭了连接)等下一次查询时处理
+            if(conn->fd >= 0){
+                epoll_ctl(epollFd_, EPOLL_CTL_DEL, conn->fd, nullptr);
+                conn->fd = -1;
+            }
+            return;
+    }
+}
+void AsyncSqlConnPool::HandleEvents(){
+    assert(InLoopThread());
+    struct epoll_event events[MAX_EVENTS];
+    int n = epoll_wait(epollFd_, events, MAX_EVENTS, 0);
+    bool timer = false;
+    for(int i = 0; i < n; i++){
+        uint64_t id = events[i].data.u64;
+        if(id == WAKE_ID || id == TIMER_ID){
+            uint64_t count;
+            ssize_t len = read(id == WAKE_ID ? wakeFd_ : timerFd_, &count, sizeof(count));
+            (void)len;
+            timer = timer || id == TIMER_ID;
+            continue;
+        }
+        Conn* conn = conns_[id].get();
+        uint32_t revents = events[i].events;
+        int status = 0;
+        if(revents & (EPOLLIN | EPOLLHUP | EPOLLERR)){//出错时让接口自己读到错误
+            status |= MYSQL_WAIT_READ;
+        }
+        if(revents & (EPOLLOUT | EPOLLHUP | EPOLLERR)){
+            status |= MYSQL_WAIT_WRITE;
+        }
+        if(revents & EPOLLPRI){
+            status |= MYSQL_WAIT_EXCEPT;
+        }
+        Continue_(conn, status);
+    }
+    Drain_();
+    if(timer){
+        timerDeadline_ = 0;
+        CheckTimeout_();
+    }
+}
+void AsyncSqlConnPool::CheckTimeout_(){
+    int64_t now = NowMs();
+    for(auto& item : conns_){
+        Conn* conn = item.get();
+        if(!conn->deadline || conn->deadline > now){
+            continue;
+        }
+        conn->deadline = 0;
+        if(conn->state == CONN_BROKEN){
+            Reconnect_(conn);
+        }else{
+            Continue_(conn, MYSQL_WAIT_TIMEOUT);
+        }
+    }
+    RearmTimer_();
+}
+void AsyncSqlConnPool::RearmTimer_(){
+    int64_t next = 0;
+    for(auto& conn : conns_){
+        if(conn->deadline && (!next || conn->deadline < next)){
+            next = conn->deadline;
+        }
+    }
+    if(next == timerDeadline_ || timerFd_ < 0){
+        return;
+    }
+    timerDeadline_ = next;
+    struct itimerspec spec = {{0, 0}, {0, 0}};//全0表示取消
+    spec.it_value.tv_sec = next / 1000;
+    spec.it_value.tv_nsec = next % 1000 * 1000000;
+    timerfd_settime(timerFd_, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+void AsyncSqlConnPool::ClosePool(){
+    Drain_();
+    std::deque<Request> canceled;
+    for(auto& conn : conns_){
+        if(conn->state == CONN_QUERY || conn->state == CONN_STORE){
+            canceled.push_back(std::move(conn->request));
+        }
+        if(conn->sql){
+            mysql_close(conn->sql);
+            conn->sql = nullptr;
+        }
+    }
+    for(auto& request : waiting_){
+        canceled.push_back(std::move(request));
+    }
+    conns_.clear();
+    free_.clear();
+    waiting_.clear();
+    for(int* fd : {&epollFd_, &wakeFd_, &timerFd_}){
+        if(*fd >= 0){
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    for(auto& request : canceled){//没有完成的查询以错误结束
+        AsyncSqlResult result;
+        result.err = CR_CONNECTION_ERROR;
+        result.error = "connection pool closed";
+        if(request.call_back){
+            request.call_back(result);
+        }
+    }
+}
@@ -0,0 +1,214 @@
+/**
+ * @file async_sql_pool.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 基于MariaDB非阻塞接口的异步数据库连接池
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _ASYNC_SQL_POOL_H_
+#define _ASYNC_SQL_POOL_H_
+#include "../timer/mpsc_queue.hpp"
+#include <mysql/mysql.h>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+/**
+ * @brief 异步查询的结果，只在回调里有效
+ *
+ */
+struct AsyncSqlResult{
+    unsigned int err = 0;//mysql_errno，0表示成功
+    std::string error;//错误信息
+    MYSQL_RES* res = nullptr;//SELECT的结果，回调返回后释放
+    uint64_t affected_rows = 0;//没有结果集时的影响行数
+    uint64_t insert_id = 0;
+};
+/**
+ * @brief 异步数据库连接池
+ * 使用MariaDB Connector/C的mysql_*_start/_cont接口，查询在等待数据库的时候不占用任何线程。
+ * 连接池有自己的epoll fd，里面是所有连接的socket、跨线程提交用的eventfd和处理超时用的timerfd；
+ * 把Fd()以EPOLLIN加进服务器的事件循环，可读时在同一个线程调用HandleEvents推进所有连接的状态机。
+ * 连接池只由所属的事件循环线程操作，其他线程提交的查询通过无锁队列交给所属线程，回调在所属线程上执行
+ */
+class AsyncSqlConnPool{
+    public:
+        typedef std::function<void(AsyncSqlResult&)> QueryCallBack;
+        AsyncSqlConnPool();
+        ~AsyncSqlConnPool();
+        AsyncSqlConnPool(const AsyncSqlConnPool&) = delete;
+        AsyncSqlConnPool& operator=(const AsyncSqlConnPool&) = delete;
+        /**
+         * @brief 建立连接，启动时在所属线程调用，这里的连接是同步的
+         *
+         * @param conn_size 连接数
+         * @return true
+         * @return false 创建epoll、eventfd或者timerfd失败
+         */
+        bool Init(const char* host, int port, const char* user, const char* pwd, const char* db, int conn_size);
+        /**
+         * @brief 把当前线程设为所属线程，事件循环线程启动后调用
+         *
+         */
+        void BindThread(){
+            owner_ = std::this_thread::get_id();
+        }
+        bool InLoopThread() const{
+            return owner_ == std::this_thread::get_id();
+        }
+        /**
+         * @brief 加进事件循环监听可读的fd
+         *
+         * @return int
+         */
+        int Fd() const{
+            return epollFd_;
+        }
+        /**
+         * @brief 提交一条查询，可以在任意线程调用；没有空闲连接时排队
+         *
+         * @param sql
+         * @param call_back 查询结束后在所属线程上调用
+         */
+        void Query(std::string sql, QueryCallBack call_back);
+        /**
+         * @brief 处理连接池内部的所有就绪事件，Fd()可读时在所属线程调用
+         *
+         */
+        void HandleEvents();
+        /**
+         * @brief 空闲连接数，只能在所属线程调用
+         *
+         * @return size_t
+         */
+        size_t GetFreeConnCount() const{
+            return free_.size();
+        }
+        /**
+         * @brief 等待空闲连接的查询数，只能在所属线程调用
+         *
+         * @return size_t
+         */
+        size_t GetPendingCount() const{
+            return waiting_.size();
+        }
+        /**
+         * @brief 关闭所有连接，还没有完成的查询以错误结束
+         *
+         */
+        void ClosePool();
+    private:
+        enum CONN_STATE{
+            CONN_IDLE,//空闲
+            CONN_CLOSE,//重连前正在关闭断开的连接
+            CONN_CONNECT,//正在重连
+            CONN_BROKEN,//重连失败，等待下一次重连
+            CONN_QUERY,//正在发送查询
+            CONN_STORE//正在读取结果
+        };
+        struct Request{
+            std::string sql;
+            QueryCallBack call_back;
+        };
+        struct Conn{
+            size_t index = 0;//在conns_里的下标，作为epoll的数据
+            MYSQL* sql = nullptr;
+            CONN_STATE state = CONN_IDLE;
+            int fd = -1;//已经加进epoll的socket
+            int64_t deadline = 0;//等待超时或者重连的时间，0表示没有
+            Request request;
+        };
+        static const uint64_t WAKE_ID = UINT64_MAX;//eventfd在epoll里的数据
+        static const uint64_t TIMER_ID = UINT64_MAX - 1;//timerfd在epoll里的数据
+        static const int RECONNECT_MS = 1000;//重连失败后的重试间隔
+        static const int MAX_EVENTS = 64;
+        /**
+         * @brief 在所属线程上分配连接或者排队
+         *
+         * @param request
+         */
+        void Dispatch_(Request&& request);
+        /**
+         * @brief 执行其他线程提交的查询
+         *
+         */
+        void Drain_();
+        void StartQuery_(Conn* conn);
+        /**
+         * @brief 查询已经发出，开始读取结果
+         *
+         * @param conn
+         * @param err mysql_real_query的返回值
+         */
+        void QueryDone_(Conn* conn, int err);
+        /**
+         * @brief 查询结束，释放连接并调用回调
+         *
+         * @param conn
+         * @param res
+         */
+        void Finish_(Conn* conn, MYSQL_RES* res);
+        /**
+         * @brief 用epoll返回的事件或者超时继续当前操作
+         *
+         * @param conn
+         * @param status MYSQL_WAIT_*的组合
+         */
+        void Continue_(Conn* conn, int status);
+        /**
+         * @brief 按接口返回的等待状态修改socket在epoll里的事件和超时
+         *
+         * @param conn
+         * @param status
+         */
+        void Wait_(Conn* conn, int status);
+        /**
+         * @brief 非阻塞地关闭断开的连接，关闭完成后开始重连
+         *
+         * @param conn
+         */
+        void Reconnect_(Conn* conn);
+        /**
+         * @brief 旧连接已经关闭，开始非阻塞重连
+         *
+         * @param conn
+         */
+        void Connect_(Conn* conn);
+        void ConnectDone_(Conn* conn, MYSQL* ret);
+        /**
+         * @brief 连接可以处理下一条查询
+         *
+         * @param conn
+         */
+        void Release_(Conn* conn);
+        /**
+         * @brief 处理到期的超时，重新设置timerfd
+         *
+         */
+        void CheckTimeout_();
+        void RearmTimer_();
+        std::string host_;
+        int port_;
+        std::string user_;
+        std::string pwd_;
+        std::string db_;
+        int epollFd_;
+        int wakeFd_;
+        int timerFd_;
+        int64_t timerDeadline_;//timerfd当前设置的时间
+        std::vector<std::unique_ptr<Conn>> conns_;
+        std::vector<Conn*> free_;
+        std::deque<Request> waiting_;
+        std::thread::id owner_;
+        MpscQueue<Request> requests_;//其他线程提交的查询
+        alignas(64) std::atomic<bool> pending_;//有未处理的跨线程查询
+};
+#endif
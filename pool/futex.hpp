@@ -0,0 +1,39 @@
+/**
+ * @file futex.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief futex等待和唤醒
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _FUTEX_H_
+#define _FUTEX_H_
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+/**
+ * @brief addr的值等于expected时休眠，直到被唤醒或超时
+ *
+ * @param addr
+ * @param expected
+ * @param timeout 为空时一直等待
+ */
+inline void FutexWait(std::atomic<uint32_t>* addr, uint32_t expected, const struct timespec* timeout = nullptr){
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+}
+/**
+ * @brief 唤醒最多count个在addr上休眠的线程
+ *
+ * @param addr
+ * @param count
+ */
+inline void FutexWake(std::atomic<uint32_t>* addr, int count){
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+#endif
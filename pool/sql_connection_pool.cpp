@@ -2,6 +2,8 @@
 SqlConnPool::SqlConnPool(){
     useCount_ = 0;
     freeCount_ = 0;
+    MAX_CONN_ = 0;
+    closed_ = false;
 }
 SqlConnPool* SqlConnPool::Instance(){
     static SqlConnPool pool;
@@ -18,13 +20,16 @@ void SqlConnPool::Init(const char *host, int port, const char *user, const char
             LOG_ERROR("Mysql init error!");
             assert(sql);
         }
-        sql = mysql_real_connect(sql,host,user,pwd,db,port,nullptr,0);
-        if(!sql){
-            LOG_ERROR("Mysql connect error!");
+        if(!mysql_real_connect(sql,host,user,pwd,db,port,nullptr,0)){//连接失败的句柄不放进池里
+            LOG_ERROR("Mysql connect error: %s", mysql_error(sql));
+            mysql_close(sql);
+            continue;
         }
+        stmtCaches_[sql].reset(new SqlStmtCache(sql));
         connQue_.push(sql);
     }
-    MAX_CONN_ = conn_size;
+    MAX_CONN_ = connQue_.size();
+    closed_ = false;
     sem_init(&semId_,0,MAX_CONN_);
 }
 MYSQL* SqlConnPool::GetConn(){
@@ -45,19 +50,69 @@ MYSQL* SqlConnPool::GetConn(){
 void SqlConnPool::FreeConn (MYSQL*sql){
     assert(sql);
     std::lock_guard<std::mutex> locker(mtx);
+    if(closed_){//连接池关闭时还在使用的连接在归还时关闭
+        CloseConn_(sql);
+        return;
+    }
     connQue_.push(sql);
     sem_post(&semId_);
 }
 
 void SqlConnPool::ClosePool(){
     std::lock_guard<std::mutex> locker(mtx);
+    if(closed_){
+        return;
+    }
+    closed_ = true;
+    if(MAX_CONN_ == 0){
+        mysql_library_end();
+        return;
+    }
     while (!connQue_.empty())
     {   
         auto item = connQue_.front();
         connQue_.pop();
-        mysql_close(item);
+        CloseConn_(item);
+    }
+}
+
+void SqlConnPool::CloseConn_(MYSQL* sql){
+    stmtCaches_.erase(sql);//语句要在连接关闭之前关闭
+    mysql_close(sql);
+    if(--MAX_CONN_ == 0){//最后一个连接关闭后才释放客户端库
+        mysql_library_end();
+    }
+}
+
+SqlStmtCache* SqlConnPool::GetStmtCache(MYSQL* sql){
+    std::lock_guard<std::mutex> locker(mtx);
+    auto it = stmtCaches_.find(sql);
+    return it == stmtCaches_.end() ? nullptr : it->second.get();
+}
+
+bool SqlConnPool::StreamQuery(MYSQL* sql, const char* query, const SqlRowSink& sink){
+    assert(sql && query);
+    if(mysql_query(sql, query)){
+        LOG_ERROR("Mysql query error: %s", mysql_error(sql));
+        return false;
+    }
+    MYSQL_RES* res = mysql_use_result(sql);
+    if(!res){
+        return mysql_errno(sql) == 0;//没有结果集的语句
+    }
+    unsigned int fields = mysql_num_fields(res);
+    MYSQL_ROW row;
+    while((row = mysql_fetch_row(res))){
+        if(!sink(row, mysql_fetch_lengths(res), fields)){
+            break;
+        }
+    }
+    bool ok = mysql_errno(sql) == 0;
+    if(!ok){
+        LOG_ERROR("Mysql fetch error: %s", mysql_error(sql));
     }
-    mysql_library_end();
+    mysql_free_result(res);//提前停止时读完并丢弃剩余的行，连接可以继续使用
+    return ok;
 }
 
 int SqlConnPool::GetFreeConnCount(){
@@ -12,9 +12,18 @@
 #ifndef _SQL_CONN_POOL_H_
 #define _SQL_CONN_POOL_H_
 #include "../log/log.hpp"
+#include "sql_stmt_cache.hpp"
+#include <functional>
+#include <memory>
 #include <mysql/mysql.h>
 #include <queue>
 #include <semaphore.h>
+#include <unordered_map>
+/**
+ * @brief 逐行接收结果的回调，返回false时停止接收(剩余的行被丢弃)
+ * row和lengths只在回调里有效
+ */
+typedef std::function<bool(MYSQL_ROW row, const unsigned long* lengths, unsigned int fields)> SqlRowSink;
 class SqlConnPool
 {
 public:
@@ -22,19 +31,53 @@ public:
     MYSQL *GetConn();
     void FreeConn(MYSQL *sql);
     int GetFreeConnCount();
+    /**
+     * @brief 连接的预处理语句缓存，只有持有连接的线程可以使用
+     * 缓存在连接关闭时销毁，而连接只在空闲或者归还时关闭，所以归还连接之前返回的指针一直有效
+     *
+     * @param sql GetConn得到的连接
+     * @return SqlStmtCache*
+     */
+    SqlStmtCache *GetStmtCache(MYSQL *sql);
+    /**
+     * @brief 执行查询并用mysql_use_result逐行把结果交给sink，不在客户端缓存整个结果集
+     *
+     * @param sql
+     * @param query
+     * @param sink
+     * @return true
+     * @return false 查询或者读取出错
+     */
+    static bool StreamQuery(MYSQL *sql, const char *query, const SqlRowSink &sink);
 
+    /**
+     * @brief 建立conn_size个连接，连接失败的不放进池里
+     *
+     */
     void Init(const char *host, int port, const char *user, const char *pwd, const char *db, int conn_size);
+    /**
+     * @brief 关闭空闲的连接，正在使用的连接在FreeConn归还时关闭
+     *
+     */
     void ClosePool();
 private:
     SqlConnPool();
     ~SqlConnPool();
     SqlConnPool &operator=(const SqlConnPool &other) = delete;
     SqlConnPool(const SqlConnPool &other) = delete;
-    int MAX_CONN_;
+    /**
+     * @brief 持有锁时关闭连接和它的语句缓存
+     *
+     * @param sql
+     */
+    void CloseConn_(MYSQL *sql);
+    int MAX_CONN_;//还没有关闭的连接数
     int useCount_;
     int freeCount_;
 
     std::queue<MYSQL *> connQue_;
+    std::unordered_map<MYSQL *, std::unique_ptr<SqlStmtCache>> stmtCaches_;//查找和删除都持有mtx
+    bool closed_;
     std::mutex mtx;
     sem_t semId_;
 };
@@ -19,12 +19,49 @@ class SqlConnRAII{
             *sql = conn_pool->GetConn();
             sql_ = *sql;
             conn_pool_ = conn_pool;
+            stmts_ = sql_ ? conn_pool->GetStmtCache(sql_) : nullptr;
         }
         ~SqlConnRAII(){
-            if(sql_) conn_pool_->FreeConn(sql_);
+            if(sql_){
+                if(stmts_){
+                    stmts_->Release();
+                }
+                conn_pool_->FreeConn(sql_);
+            }
+        }
+        /**
+         * @brief 取得这个连接上缓存的预处理语句，第一次使用时prepare
+         *
+         * @param query 带?占位符的SQL
+         * @return MYSQL_STMT* 没有连接或者prepare失败时返回nullptr
+         */
+        MYSQL_STMT* Prepare(const std::string& query){
+            return stmts_ ? stmts_->Get(query) : nullptr;
+        }
+        /**
+         * @brief 读取Prepare得到的语句的下一行，读完的语句归还连接时不需要重置
+         *
+         * @param stmt
+         * @return int mysql_stmt_fetch的返回值
+         */
+        int Fetch(MYSQL_STMT* stmt){
+            assert(stmts_);
+            return stmts_->Fetch(stmt);
+        }
+        /**
+         * @brief 执行查询并逐行把结果交给sink
+         *
+         * @param query
+         * @param sink
+         * @return true
+         * @return false 没有连接或者出错
+         */
+        bool Stream(const char* query, const SqlRowSink& sink){
+            return sql_ && SqlConnPool::StreamQuery(sql_, query, sink);
         }
     private:
         MYSQL* sql_;
         SqlConnPool *conn_pool_;
+        SqlStmtCache* stmts_;
 };
 #endif
\ No newline at end of file
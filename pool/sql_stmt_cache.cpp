@@ -0,0 +1,83 @@
+#include "sql_stmt_cache.hpp"
+#include "../log/log.hpp"
+#include <assert.h>
+SqlStmtCache::SqlStmtCache(MYSQL* sql, size_t capacity):sql_(sql),capacity_(capacity){
+    assert(capacity > 0);
+}
+SqlStmtCache::~SqlStmtCache(){
+    Clear();
+}
+MYSQL_STMT* SqlStmtCache::Get(const std::string& query){
+    MYSQL_STMT* stmt = nullptr;
+    auto it = index_.find(query);
+    if(it != index_.end()){
+        stmts_.splice(stmts_.begin(), stmts_, it->second);
+        stmt = it->second->second;
+    }else{
+        stmt = mysql_stmt_init(sql_);
+        if(!stmt){
+            LOG_ERROR("Mysql stmt init error!");
+            return nullptr;
+        }
+        if(mysql_stmt_prepare(stmt, query.data(), query.size())){
+            LOG_ERROR("Mysql prepare error: %s", mysql_stmt_error(stmt));
+            mysql_stmt_close(stmt);
+            return nullptr;
+        }
+        if(stmts_.size() >= capacity_){
+            dirty_.erase(stmts_.back().second);
+            mysql_stmt_close(stmts_.back().second);
+            index_.erase(stmts_.back().first);
+            stmts_.pop_back();
+        }
+        stmts_.emplace_front(query, stmt);
+        index_[query] = stmts_.begin();
+    }
+    if(mysql_stmt_field_count(stmt) > 0){//没有结果集的语句执行完就结束了，不会留下没读的行
+        dirty_.insert(stmt);
+    }
+    return stmt;
+}
+int SqlStmtCache::Fetch(MYSQL_STMT* stmt){
+    int ret = mysql_stmt_fetch(stmt);
+    if(ret == MYSQL_NO_DATA){
+        dirty_.erase(stmt);
+    }
+    return ret;
+}
+void SqlStmtCache::Release(){
+    for(MYSQL_STMT* stmt : dirty_){
+        //mysql_stmt_free_result只释放客户端已经缓存的结果，没有读完的行还在连接上，
+        //要用mysql_stmt_reset丢弃，代价是一次和服务器的往返
+        if(mysql_stmt_reset(stmt)){
+            LOG_ERROR("Mysql stmt reset error: %s", mysql_stmt_error(stmt));
+            for(auto it = stmts_.begin(); it != stmts_.end(); ++it){//语句已经不可用，下次使用时重新prepare
+                if(it->second == stmt){
+                    mysql_stmt_close(stmt);
+                    index_.erase(it->first);
+                    stmts_.erase(it);
+                    break;
+                }
+            }
+        }
+    }
+    dirty_.clear();
+}
+void SqlStmtCache::Erase(const std::string& query){
+    auto it = index_.find(query);
+    if(it == index_.end()){
+        return;
+    }
+    dirty_.erase(it->second->second);
+    mysql_stmt_close(it->second->second);
+    stmts_.erase(it->second);
+    index_.erase(it);
+}
+void SqlStmtCache::Clear(){
+    for(auto& item : stmts_){
+        mysql_stmt_close(item.second);
+    }
+    stmts_.clear();
+    index_.clear();
+    dirty_.clear();
+}
@@ -0,0 +1,79 @@
+/**
+ * @file sql_stmt_cache.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 每个数据库连接的预处理语句缓存
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _SQL_STMT_CACHE_H_
+#define _SQL_STMT_CACHE_H_
+#include <mysql/mysql.h>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+/**
+ * @brief 按SQL文本缓存一个连接上已经prepare过的语句，超过容量时关闭最久没用的
+ * 连接同一时间只属于一个使用者，缓存不加锁；语句在服务器端只解析一次，之后只发送参数。
+ * 有结果集的语句取出后记为脏，用Fetch读到MYSQL_NO_DATA后变干净；归还连接时只重置还脏的语句，
+ * 干净的语句再次取出不需要和服务器通信
+ */
+class SqlStmtCache{
+    public:
+        /**
+         * @brief 创建缓存
+         *
+         * @param sql 所属的连接
+         * @param capacity 最多缓存的语句数，受服务器max_prepared_stmt_count限制
+         */
+        explicit SqlStmtCache(MYSQL* sql, size_t capacity = 64);
+        ~SqlStmtCache();
+        SqlStmtCache(const SqlStmtCache&) = delete;
+        SqlStmtCache& operator=(const SqlStmtCache&) = delete;
+        /**
+         * @brief 取出缓存的语句，没有时prepare并放进缓存
+         *
+         * @param query
+         * @return MYSQL_STMT* prepare失败时返回nullptr
+         */
+        MYSQL_STMT* Get(const std::string& query);
+        /**
+         * @brief mysql_stmt_fetch，读完结果集时把语句记为干净
+         *
+         * @param stmt Get返回的语句
+         * @return int mysql_stmt_fetch的返回值
+         */
+        int Fetch(MYSQL_STMT* stmt);
+        /**
+         * @brief 归还连接前调用，用mysql_stmt_reset丢弃脏语句没有读完的行并关闭服务器端的游标
+         *
+         */
+        void Release();
+        /**
+         * @brief 关闭并删除一条语句，比如执行时发现连接已经断开
+         *
+         * @param query
+         */
+        void Erase(const std::string& query);
+        /**
+         * @brief 关闭所有语句
+         *
+         */
+        void Clear();
+        size_t size() const{
+            return stmts_.size();
+        }
+    private:
+        typedef std::list<std::pair<std::string, MYSQL_STMT*>> StmtList;
+        MYSQL* sql_;
+        size_t capacity_;
+        StmtList stmts_;//最近使用的在前面
+        std::unordered_map<std::string, StmtList::iterator> index_;
+        std::unordered_set<MYSQL_STMT*> dirty_;//结果集可能没有读完的语句
+};
+#endif
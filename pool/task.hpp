@@ -0,0 +1,145 @@
+/**
+ * @file task.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 不分配内存的任务类型
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _TASK_H_
+#define _TASK_H_
+#include <assert.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+/**
+ * @brief 只能移动的小对象优化任务
+ * 可调用对象不超过InlineSize时直接构造在内部存储里，超过时才放到堆上
+ * @tparam InlineSize 内部存储的字节数
+ */
+template<size_t InlineSize>
+class InlineTask{
+    public:
+        InlineTask() = default;
+        template<typename F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, InlineTask>::value>::type>
+        InlineTask(F&& func){
+            Emplace(std::forward<F>(func));
+        }
+        InlineTask(InlineTask&& other) noexcept{
+            MoveFrom_(other);
+        }
+        InlineTask& operator=(InlineTask&& other) noexcept{
+            if(this != &other){
+                Reset();
+                MoveFrom_(other);
+            }
+            return *this;
+        }
+        InlineTask(const InlineTask&) = delete;
+        InlineTask& operator=(const InlineTask&) = delete;
+        ~InlineTask(){
+            Reset();
+        }
+        /**
+         * @brief 构造可调用对象
+         *
+         * @tparam F
+         * @param func
+         * @return true 放在了内部存储
+         * @return false 超过内部存储，放在了堆上
+         */
+        template<typename F>
+        bool Emplace(F&& func){
+            typedef typename std::decay<F>::type Func;
+            Reset();
+            if(FitsInline<Func>()){
+                new (storage_) Func(std::forward<F>(func));
+                ops_ = &InlineOps_<Func>::ops;
+                return true;
+            }
+            *reinterpret_cast<Func**>(storage_) = new Func(std::forward<F>(func));
+            ops_ = &HeapOps_<Func>::ops;
+            return false;
+        }
+        /**
+         * @brief 可调用对象能否放进内部存储
+         *
+         * @tparam Func
+         * @return true
+         * @return false
+         */
+        template<typename Func>
+        static constexpr bool FitsInline(){
+            return sizeof(Func) <= InlineSize && alignof(Func) <= alignof(std::max_align_t)
+                && std::is_nothrow_move_constructible<Func>::value;
+        }
+        void operator()(){
+            assert(ops_);
+            ops_->invoke(storage_);
+        }
+        /**
+         * @brief 销毁可调用对象
+         *
+         */
+        void Reset(){
+            if(ops_){
+                ops_->destroy(storage_);
+                ops_ = nullptr;
+            }
+        }
+        explicit operator bool() const{
+            return ops_ != nullptr;
+        }
+    private:
+        static_assert(InlineSize >= sizeof(void*), "inline size must hold a pointer");
+        /**
+         * @brief 类型擦除后的操作表
+         *
+         */
+        struct Ops{
+            void (*invoke)(void*);
+            void (*move)(void* dst, void* src);//移动到dst并销毁src
+            void (*destroy)(void*);
+        };
+        template<typename Func>
+        struct InlineOps_{
+            static void Invoke(void* p){
+                (*static_cast<Func*>(p))();
+            }
+            static void Move(void* dst, void* src){
+                new (dst) Func(std::move(*static_cast<Func*>(src)));
+                static_cast<Func*>(src)->~Func();
+            }
+            static void Destroy(void* p){
+                static_cast<Func*>(p)->~Func();
+            }
+            static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+        };
+        template<typename Func>
+        struct HeapOps_{
+            static void Invoke(void* p){
+                (**static_cast<Func**>(p))();
+            }
+            static void Move(void* dst, void* src){//堆上的对象只移动指针
+                *static_cast<Func**>(dst) = *static_cast<Func**>(src);
+            }
+            static void Destroy(void* p){
+                delete *static_cast<Func**>(p);
+            }
+            static constexpr Ops ops = {&Invoke, &Move, &Destroy};
+        };
+        void MoveFrom_(InlineTask& other){
+            ops_ = other.ops_;
+            if(ops_){
+                ops_->move(storage_, other.storage_);
+                other.ops_ = nullptr;
+            }
+        }
+        alignas(std::max_align_t) unsigned char storage_[InlineSize];//可调用对象的内部存储
+        const Ops* ops_ = nullptr;
+};
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file task_future.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 线程池任务的结果
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _TASK_FUTURE_H_
+#define _TASK_FUTURE_H_
+#include "futex.hpp"
+#include <assert.h>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <utility>
+/**
+ * @brief 任务完成状态，只在有线程等待时才调用futex唤醒
+ *
+ */
+class FutureSignal{
+    public:
+        bool Ready() const{
+            return state_.load(std::memory_order_acquire) == READY;
+        }
+        /**
+         * @brief 等待任务完成
+         *
+         */
+        void Wait(){
+            uint32_t s = state_.load(std::memory_order_acquire);
+            while(s != READY){
+                if(s == PENDING && !state_.compare_exchange_weak(s, WAITING, std::memory_order_acquire)){
+                    continue;
+                }
+                FutexWait(&state_, WAITING);
+                s = state_.load(std::memory_order_acquire);
+            }
+        }
+        /**
+         * @brief 标记完成并唤醒等待的线程
+         *
+         */
+        void Set(){
+            if(state_.exchange(READY, std::memory_order_acq_rel) == WAITING){
+                FutexWake(&state_, INT32_MAX);
+            }
+        }
+    private:
+        static constexpr uint32_t PENDING = 0;
+        static constexpr uint32_t READY = 1;
+        static constexpr uint32_t WAITING = 2;//未完成且有线程在等待
+        std::atomic<uint32_t> state_{PENDING};
+};
+/**
+ * @brief 任务结果的共享状态
+ *
+ * @tparam R
+ */
+template<typename R>
+struct FutureState{
+    FutureSignal signal;
+    std::optional<R> value;
+    std::exception_ptr error;
+    template<typename F>
+    void Run(F& func){
+        try{
+            value.emplace(func());
+        }catch(...){
+            error = std::current_exception();
+        }
+        signal.Set();
+    }
+    R Take(){
+        if(error){
+            std::rethrow_exception(error);
+        }
+        return std::move(*value);
+    }
+};
+template<>
+struct FutureState<void>{
+    FutureSignal signal;
+    std::exception_ptr error;
+    template<typename F>
+    void Run(F& func){
+        try{
+            func();
+        }catch(...){
+            error = std::current_exception();
+        }
+        signal.Set();
+    }
+    void Take(){
+        if(error){
+            std::rethrow_exception(error);
+        }
+    }
+};
+/**
+ * @brief 轻量的任务结果，只能取一次
+ *
+ * @tparam R
+ */
+template<typename R>
+class TaskFuture{
+    public:
+        TaskFuture() = default;
+        explicit TaskFuture(std::shared_ptr<FutureState<R>> state):state_(std::move(state)){}
+        bool Valid() const{
+            return static_cast<bool>(state_);
+        }
+        bool Ready() const{
+            assert(state_);
+            return state_->signal.Ready();
+        }
+        void Wait() const{
+            assert(state_);
+            state_->signal.Wait();
+        }
+        /**
+         * @brief 等待并取出结果，任务抛出的异常在这里重新抛出
+         *
+         * @return R
+         */
+        R Get(){
+            assert(state_);
+            state_->signal.Wait();
+            std::shared_ptr<FutureState<R>> state = std::move(state_);
+            return state->Take();
+        }
+    private:
+        std::shared_ptr<FutureState<R>> state_;
+};
+#endif
@@ -1 +1,254 @@
-#include "thread_pool.hpp"
\ No newline at end of file
+#include "thread_pool.hpp"
+#include "futex.hpp"
+#include <chrono>
+#include <climits>
+#include <pthread.h>
+#include <sched.h>
+namespace {
+/**
+ * @brief 当前线程所属的线程池和下标
+ *
+ */
+struct CurrentWorker{
+    const ThreadPool* pool = nullptr;
+    size_t index = 0;
+};
+thread_local CurrentWorker current_worker;
+}
+
+namespace {
+ThreadPoolOptions MakeOptions(size_t thread_count, size_t task_slots){
+    ThreadPoolOptions options;
+    options.thread_count = thread_count;
+    options.task_slots = task_slots;
+    return options;
+}
+}
+
+ThreadPool::ThreadPool(size_t thread_count, size_t task_slots)
+    :ThreadPool(MakeOptions(thread_count, task_slots)){
+}
+
+ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+    :slots_(new TaskSlot[options.task_slots]),free_slots_(options.task_slots),options_(options){
+    assert(options.thread_count>0);//断言线程池的线程数目大于0
+    for(size_t i = 0; i < options.task_slots; i++){
+        free_slots_.TryPush(&slots_[i]);
+    }
+    for(size_t i = 0; i < options.thread_count; i++){
+        workers_.emplace_back(new Worker());
+        workers_[i]->rng = static_cast<uint32_t>(i * 2654435761u + 1);
+    }
+    running_.store(options.thread_count, std::memory_order_relaxed);
+    //所有队列都建好以后再启动线程，窃取时不会访问到未初始化的队列
+    for(size_t i = 0; i < options.thread_count; i++){
+        workers_[i]->thread = std::thread([this, i]{
+            WorkerLoop_(i);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    Shutdown();
+}
+
+bool ThreadPool::Shutdown(int timeout_ms){
+    std::lock_guard<std::mutex> locker(shutdown_mtx_);
+    if(shutdown_){
+        return drained_;
+    }
+    closed_.store(true, std::memory_order_seq_cst);
+    epoch_.fetch_add(1, std::memory_order_seq_cst);
+    FutexWake(&epoch_, INT_MAX);//唤醒所有线程处理完剩余任务后退出
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while(true){
+        uint32_t exited = exited_.load(std::memory_order_acquire);
+        if(running_.load(std::memory_order_acquire) == 0){
+            break;
+        }
+        if(timeout_ms < 0){
+            FutexWait(&exited_, exited);
+            continue;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+        if(left.count() <= 0){//超时就放弃排队的任务
+            abort_.store(true, std::memory_order_seq_cst);
+            drained_ = false;
+            break;
+        }
+        struct timespec ts;
+        ts.tv_sec = left.count() / 1000000000;
+        ts.tv_nsec = left.count() % 1000000000;
+        FutexWait(&exited_, exited, &ts);
+    }
+    for(auto& worker : workers_){
+        if(worker->thread.joinable()){
+            worker->thread.join();
+        }
+    }
+    //超时放弃的任务在这里销毁，释放它们捕获的资源
+    TaskSlot* task = nullptr;
+    while((task = inject_.TryPop())){
+        ReleaseSlot_(task);
+    }
+    for(auto& worker : workers_){
+        while((task = worker->deque.Steal())){
+            ReleaseSlot_(task);
+        }
+    }
+    shutdown_ = true;
+    return drained_;
+}
+
+void ThreadPool::SetupWorker_(size_t index){
+    if(options_.pin_cpu){
+        int cpu = AllowedCpu(options_.first_cpu + index);
+        if(cpu >= 0){
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(cpu, &mask);
+            pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+        }
+    }
+}
+
+int ThreadPool::AllowedCpu(size_t index){
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if(sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0){
+        return -1;
+    }
+    //在进程允许的CPU里按序号轮流选择
+    size_t target = index % CPU_COUNT(&allowed);
+    for(int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+        if(CPU_ISSET(cpu, &allowed) && target-- == 0){
+            return cpu;
+        }
+    }
+    return -1;
+}
+
+ThreadPool::TaskSlot* ThreadPool::AcquireSlot_(){
+    TaskSlot* slot = free_slots_.TryPop();
+    if(!slot){//积压的任务超过任务槽数才会走到这里
+        slot = new TaskSlot();
+        slot->heap = true;
+        heap_slots_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return slot;
+}
+
+void ThreadPool::ReleaseSlot_(TaskSlot* slot){
+    slot->task.Reset();
+    if(slot->heap){
+        delete slot;
+    }else{
+        free_slots_.TryPush(slot);//空闲队列容量等于槽数，不会失败
+    }
+}
+
+ThreadPoolStats ThreadPool::Stats() const{
+    ThreadPoolStats stats;
+    stats.heap_slots = heap_slots_.load(std::memory_order_relaxed);
+    stats.heap_captures = heap_captures_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ThreadPool::Push_(TaskSlot* task){
+    Enqueue_(task);
+    Wake_(1);
+}
+
+void ThreadPool::Enqueue_(TaskSlot* task){
+    bool pushed = false;
+    if(current_worker.pool == this){//工作线程内提交的任务放进自己的队列
+        pushed = workers_[current_worker.index]->deque.Push(task);
+    }
+    while(!pushed){
+        pushed = inject_.TryPush(task);
+        if(!pushed){//注入队列满了就让出CPU等待消费
+            Wake_(1);
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::Wake_(int count){
+    if(count <= 0){
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);//和休眠线程的检查配对，避免丢失唤醒
+    if(sleepers_.load(std::memory_order_relaxed) > 0){
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        FutexWake(&epoch_, count);
+    }
+}
+
+ThreadPool::TaskSlot* ThreadPool::FindTask_(size_t index){
+    Worker& self = *workers_[index];
+    TaskSlot* task = self.deque.Pop();
+    if(task){
+        return task;
+    }
+    task = inject_.TryPop();
+    if(task){
+        return task;
+    }
+    const size_t n = workers_.size();
+    //xorshift随机选择开始窃取的线程，避免所有线程都去抢同一个
+    self.rng ^= self.rng << 13;
+    self.rng ^= self.rng >> 17;
+    self.rng ^= self.rng << 5;
+    size_t start = self.rng % n;
+    for(size_t i = 0; i < n; i++){
+        size_t victim = (start + i) % n;
+        if(victim == index){
+            continue;
+        }
+        task = workers_[victim]->deque.Steal();
+        if(task){
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::WorkerLoop_(size_t index){
+    current_worker.pool = this;
+    current_worker.index = index;
+    SetupWorker_(index);
+    while(!abort_.load(std::memory_order_relaxed)){
+        TaskSlot* task = FindTask_(index);
+        if(!task){
+            //先登记休眠再检查一次队列，提交者看到登记就一定会改变epoch
+            sleepers_.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            uint32_t epoch = epoch_.load(std::memory_order_seq_cst);
+            task = FindTask_(index);
+            if(!task && !closed_.load(std::memory_order_seq_cst)){
+                FutexWait(&epoch_, epoch);
+            }
+            sleepers_.fetch_sub(1, std::memory_order_relaxed);
+            if(!task){
+                if(closed_.load(std::memory_order_acquire)){
+                    task = FindTask_(index);
+                    if(!task){//关闭且没有剩余任务就退出
+                        break;
+                    }
+                }else{
+                    continue;
+                }
+            }
+        }
+        if(abort_.load(std::memory_order_relaxed)){//超时放弃的任务交给Shutdown销毁
+            Enqueue_(task);
+            break;
+        }
+        task->task();
+        ReleaseSlot_(task);
+    }
+    current_worker.pool = nullptr;
+    running_.fetch_sub(1, std::memory_order_acq_rel);
+    exited_.fetch_add(1, std::memory_order_release);
+    FutexWake(&exited_, INT_MAX);
+}
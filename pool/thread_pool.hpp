@@ -1,74 +1,294 @@
 /**
  * @file thread_pool.hpp
  * @author {gangx} ({gangx6906@gmail.com})
- * @brief 
+ * @brief
  * @version 0.1
  * @date 2024-05-04
- * 
+ *
  * @copyright Copyright (c) 2024
- * 
+ *
  */
 #pragma once
 #ifndef _THREAD_POOL_H_
 #define _THREAD_POOL_H_
-#include <mutex>
-#include <condition_variable>
-#include <queue>
+#include "task.hpp"
+#include "task_future.hpp"
+#include "work_steal_deque.hpp"
+#include <atomic>
 #include <assert.h>
-#include <functional>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
+#include <vector>
+#ifndef THREAD_POOL_TASK_SIZE
+#define THREAD_POOL_TASK_SIZE 64 //任务内部存储的字节数，捕获超过这个大小的任务会在堆上分配
+#endif
+/**
+ * @brief 线程池内存分配的统计
+ *
+ */
+struct ThreadPoolStats{
+    size_t heap_slots = 0;//任务槽用完后在堆上分配槽的次数
+    size_t heap_captures = 0;//可调用对象超过内部存储在堆上分配的次数
+};
 /**
-* @brief 一个基本的处理队列池
-* 
-*/
-struct Pool{
-    std::mutex mtx;
-    std::condition_variable cond;
-    bool isClosed;
-    std::queue<std::function<void()>> tasks;
+ * @brief 线程池的配置
+ *
+ */
+struct ThreadPoolOptions{
+    size_t thread_count = 8;//工作线程数
+    size_t task_slots = 16384;//预先分配的任务槽数，必须是2的幂
+    bool pin_cpu = false;//是否把每个工作线程绑定到一个CPU
+    size_t first_cpu = 0;//第一个工作线程绑定的CPU在可用CPU中的序号
 };
+/**
+ * @brief 工作窃取线程池
+ * 每个工作线程有自己的Chase-Lev队列，工作线程内提交的任务进入自己的队列，
+ * 外部线程提交的任务进入无锁注入队列；空闲的线程从其他线程窃取任务，都没有任务时在futex上休眠。
+ * 任务构造在预先分配的任务槽里，捕获不超过THREAD_POOL_TASK_SIZE的任务提交时不访问全局分配器
+ */
 class ThreadPool{
     public:
-        explicit ThreadPool(size_t thread_count = 8):pool_(std::shared_ptr<Pool>()){
-            assert(thread_count>0);//断言线程池的线程数目大于0
-            for(int i = 0; i < thread_count;i++){
-                std::thread([pool = pool_]{//创建线程池工作线程
-                    std::unique_lock<std::mutex> locker(pool->mtx);
-                    while (true)
-                    {
-                        if(!pool->tasks.empty())
-                        {
-                            auto task = std::move(pool->tasks.front());
-                            pool->tasks.pop();
-                            locker.unlock();
-                            task();
-                            locker.lock();
-                        }else if(pool->isClosed) break;
-                        else pool->cond.wait(locker);
-                    }
-                }).detach();                
+        typedef InlineTask<THREAD_POOL_TASK_SIZE> Task;
+        /**
+         * @brief 创建线程池
+         *
+         * @param thread_count 工作线程数
+         * @param task_slots 预先分配的任务槽数，必须是2的幂
+         */
+        explicit ThreadPool(size_t thread_count = 8, size_t task_slots = 16384);
+        /**
+         * @brief 按配置创建线程池
+         *
+         * @param options
+         */
+        explicit ThreadPool(const ThreadPoolOptions& options);
+        /**
+         * @brief 关闭线程池，等待已提交的任务执行完毕
+         *
+         */
+        ~ThreadPool();
+        /**
+         * @brief 关闭线程池并等待工作线程退出，可以重复调用
+         * 在超时之前执行完所有排队的任务；超时后不再执行排队的任务，丢弃它们并等待正在执行的任务结束
+         *
+         * @param timeout_ms 超时时间，单位毫秒，小于0表示一直等待
+         * @return true 所有任务都执行完毕
+         * @return false 超时，有任务被丢弃
+         */
+        bool Shutdown(int timeout_ms = -1);
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        /**
+         * @brief 提交任务
+         *
+         * @tparam T
+         * @param task
+         */
+        template<typename T>
+        void AddTasK(T &&task){
+            TaskSlot* slot = AcquireSlot_();
+            if(!slot->task.Emplace(std::forward<T>(task))){
+                heap_captures_.fetch_add(1, std::memory_order_relaxed);
             }
+            Push_(slot);
+        }
+        /**
+         * @brief 提交任务并返回结果
+         *
+         * @tparam F
+         * @param func
+         * @return TaskFuture<R> 
+         */
+        template<typename F>
+        auto Submit(F &&func) -> TaskFuture<typename std::invoke_result<typename std::decay<F>::type&>::type>{
+            typedef typename std::invoke_result<typename std::decay<F>::type&>::type R;
+            std::shared_ptr<FutureState<R>> state = std::make_shared<FutureState<R>>();
+            AddTasK([state, func = std::forward<F>(func)]() mutable {
+                state->Run(func);
+            });
+            return TaskFuture<R>(std::move(state));
         }
-        ThreadPool() = default;
-        ~ThreadPool(){
-            if(static_cast<bool>(pool_)){
-                {
-                    std::lock_guard<std::mutex> locker(pool_->mtx);
-                    pool_->isClosed = true;
+        /**
+         * @brief 批量提交任务，所有任务入队后只唤醒一次
+         *
+         * @tparam Container 可调用对象的容器，元素会被移走
+         * @param tasks
+         */
+        template<typename Container>
+        void SubmitBatch(Container &&tasks){
+            size_t count = 0;
+            for(auto& task : tasks){
+                TaskSlot* slot = AcquireSlot_();
+                if(!slot->task.Emplace(std::move(task))){
+                    heap_captures_.fetch_add(1, std::memory_order_relaxed);
                 }
-                pool_->cond.notify_all();
+                Enqueue_(slot);
+                count++;
             }
+            Wake_(static_cast<int>(count < workers_.size() ? count : workers_.size()));
         }
-        template<typename T>
-        void AddTasK(T &&task){
-            {
-                std::lock_guard<std::mutex> locker(pool_->mtx);
-                pool_->tasks.emplace(std::forward<T>(task));
+        /**
+         * @brief 把[begin,end)按chunk切块并行执行body(lo,hi)，调用线程也参与执行，全部完成后返回
+         *
+         * @tparam F
+         * @param begin
+         * @param end
+         * @param body
+         * @param chunk 每块的下标数，0表示按线程数自动切分
+         */
+        template<typename F>
+        void ParallelFor(size_t begin, size_t end, F &&body, size_t chunk = 0){
+            if(begin >= end){
+                return;
+            }
+            const size_t total = end - begin;
+            if(chunk == 0){//每个线程大约分到4块，兼顾负载均衡和调度开销
+                chunk = total / (workers_.size() * 4);
+                chunk = chunk > 0 ? chunk : 1;
             }
-            pool_->cond.notify_one();
+            std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+            state->chunks = (total + chunk - 1) / chunk;
+            typename std::remove_reference<F>::type* func = &body;
+            auto runner = [state, begin, end, chunk, func]{
+                while(true){
+                    size_t c = state->next.fetch_add(1, std::memory_order_relaxed);
+                    if(c >= state->chunks){
+                        break;
+                    }
+                    size_t lo = begin + c * chunk;
+                    size_t hi = end - lo > chunk ? lo + chunk : end;
+                    (*func)(lo, hi);
+                    if(state->finished.fetch_add(1, std::memory_order_acq_rel) + 1 == state->chunks){
+                        state->done.Set();
+                    }
+                }
+            };
+            size_t helpers = state->chunks - 1 < workers_.size() ? state->chunks - 1 : workers_.size();
+            for(size_t i = 0; i < helpers; i++){
+                TaskSlot* slot = AcquireSlot_();
+                slot->task.Emplace(runner);
+                Enqueue_(slot);
+            }
+            Wake_(static_cast<int>(helpers));
+            runner();
+            state->done.Wait();
+        }
+        /**
+         * @brief 获取内存分配的统计
+         *
+         * @return ThreadPoolStats
+         */
+        ThreadPoolStats Stats() const;
+        /**
+         * @brief 工作线程数
+         *
+         * @return size_t
+         */
+        size_t ThreadCount() const{
+            return workers_.size();
         }
+        /**
+         * @brief 进程CPU掩码里的第index个CPU，index超过CPU个数时从头轮流
+         *
+         * @param index
+         * @return int CPU编号，取不到掩码时返回-1
+         */
+        static int AllowedCpu(size_t index);
     private:
-        
-        std::shared_ptr<Pool> pool_;
+        /**
+         * @brief 任务槽
+         *
+         */
+        struct TaskSlot{
+            Task task;
+            bool heap = false;//是否是槽用完后在堆上分配的
+        };
+        /**
+         * @brief ParallelFor的共享进度
+         *
+         */
+        struct ParallelForState{
+            std::atomic<size_t> next{0};//下一个要领取的块
+            std::atomic<size_t> finished{0};//已经完成的块
+            size_t chunks = 0;
+            FutureSignal done;
+        };
+        /**
+         * @brief 工作线程的状态
+         *
+         */
+        struct alignas(64) Worker{
+            ChaseLevDeque<TaskSlot> deque;//本线程的任务队列
+            std::thread thread;
+            uint32_t rng;//选择窃取对象的随机数状态
+        };
+        /**
+         * @brief 取一个空闲的任务槽，用完时在堆上分配
+         *
+         * @return TaskSlot*
+         */
+        TaskSlot* AcquireSlot_();
+        /**
+         * @brief 归还任务槽
+         *
+         * @param slot
+         */
+        void ReleaseSlot_(TaskSlot* slot);
+        /**
+         * @brief 按配置把工作线程绑定到进程允许的一个CPU上
+         *
+         * @param index
+         */
+        void SetupWorker_(size_t index);
+        /**
+         * @brief 放入任务，不唤醒
+         *
+         * @param task
+         */
+        void Enqueue_(TaskSlot* task);
+        /**
+         * @brief 放入任务并在有线程休眠时唤醒一个
+         *
+         * @param task
+         */
+        void Push_(TaskSlot* task);
+        /**
+         * @brief 工作线程主循环
+         *
+         * @param index
+         */
+        void WorkerLoop_(size_t index);
+        /**
+         * @brief 依次从本线程队列、注入队列和其他线程队列取任务
+         *
+         * @param index
+         * @return TaskSlot*
+         */
+        TaskSlot* FindTask_(size_t index);
+        /**
+         * @brief 有线程休眠时用一次futex调用唤醒count个
+         *
+         * @param count
+         */
+        void Wake_(int count);
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::unique_ptr<TaskSlot[]> slots_;//预先分配的任务槽
+        InjectQueue<TaskSlot> free_slots_;//空闲的任务槽
+        InjectQueue<TaskSlot> inject_;//外部线程提交的任务
+        std::atomic<size_t> heap_slots_{0};
+        std::atomic<size_t> heap_captures_{0};
+        alignas(64) std::atomic<uint32_t> epoch_{0};//休眠线程等待的futex字
+        std::atomic<int> sleepers_{0};//正在休眠或准备休眠的线程数
+        std::atomic<bool> closed_{false};
+        std::atomic<bool> abort_{false};//超时后放弃排队的任务
+        std::atomic<size_t> running_{0};//还没有退出的工作线程数
+        std::atomic<uint32_t> exited_{0};//工作线程退出时递增，Shutdown在上面等待
+        std::mutex shutdown_mtx_;
+        bool shutdown_ = false;//Shutdown已经完成
+        bool drained_ = true;//Shutdown时是否执行完了所有任务
+        ThreadPoolOptions options_;
 };
-#endif
\ No newline at end of file
+#endif
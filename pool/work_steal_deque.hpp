@@ -0,0 +1,179 @@
+/**
+ * @file work_steal_deque.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 工作窃取队列和注入队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _WORK_STEAL_DEQUE_H_
+#define _WORK_STEAL_DEQUE_H_
+#include <assert.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+/**
+ * @brief Chase-Lev工作窃取双端队列
+ * 只有所属的工作线程可以Push和Pop(从底部)，其他线程通过Steal从顶部窃取；
+ * 容量固定，满了由调用者转投注入队列
+ * @tparam T 元素的指针类型
+ */
+template<typename T>
+class ChaseLevDeque{
+    public:
+        explicit ChaseLevDeque(size_t capacity = 4096):mask_(capacity - 1),buffer_(new std::atomic<T*>[capacity]){
+            assert(capacity > 0 && (capacity & (capacity - 1)) == 0);//容量必须是2的幂
+        }
+        /**
+         * @brief 所属线程压入底部
+         *
+         * @param item
+         * @return true
+         * @return false 队列已满
+         */
+        bool Push(T* item){
+            int64_t b = bottom_.load(std::memory_order_relaxed);
+            int64_t t = top_.load(std::memory_order_acquire);
+            if(b - t > static_cast<int64_t>(mask_)){
+                return false;
+            }
+            buffer_[b & mask_].store(item, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_release);//窃取者acquire读取bottom后能看到元素
+            return true;
+        }
+        /**
+         * @brief 所属线程从底部弹出
+         *
+         * @return T* 队列为空返回nullptr
+         */
+        T* Pop(){
+            int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top_.load(std::memory_order_relaxed);
+            if(t > b){//队列为空
+                bottom_.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            T* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+            if(t == b){//最后一个元素要和窃取者竞争
+                if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                    item = nullptr;
+                }
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+        /**
+         * @brief 其他线程从顶部窃取
+         *
+         * @return T* 队列为空或者竞争失败返回nullptr
+         */
+        T* Steal(){
+            int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom_.load(std::memory_order_acquire);
+            if(t >= b){
+                return nullptr;
+            }
+            T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+            if(!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                return nullptr;
+            }
+            return item;
+        }
+        /**
+         * @brief 大致的元素个数
+         *
+         * @return size_t
+         */
+        size_t SizeApprox() const{
+            int64_t b = bottom_.load(std::memory_order_relaxed);
+            int64_t t = top_.load(std::memory_order_relaxed);
+            return b > t ? static_cast<size_t>(b - t) : 0;
+        }
+    private:
+        alignas(64) std::atomic<int64_t> top_{0};//窃取端
+        alignas(64) std::atomic<int64_t> bottom_{0};//所属线程端
+        alignas(64) const size_t mask_;
+        std::unique_ptr<std::atomic<T*>[]> buffer_;
+};
+/**
+ * @brief 有界无锁多生产者多消费者队列，用于外部线程向线程池注入任务
+ * 每个槽位带序号，生产者和消费者各自用CAS推进位置
+ * @tparam T 元素的指针类型
+ */
+template<typename T>
+class InjectQueue{
+    public:
+        explicit InjectQueue(size_t capacity = 65536):mask_(capacity - 1),cells_(new Cell[capacity]){
+            assert(capacity > 0 && (capacity & (capacity - 1)) == 0);//容量必须是2的幂
+            for(size_t i = 0; i < capacity; i++){
+                cells_[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+        /**
+         * @brief 尝试入队
+         *
+         * @param item
+         * @return true
+         * @return false 队列已满
+         */
+        bool TryPush(T* item){
+            size_t pos = tail_.load(std::memory_order_relaxed);
+            while(true){
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if(diff == 0){
+                    if(tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                        cell.item = item;
+                        cell.seq.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                }else if(diff < 0){
+                    return false;
+                }else{
+                    pos = tail_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+        /**
+         * @brief 尝试出队
+         *
+         * @return T* 队列为空返回nullptr
+         */
+        T* TryPop(){
+            size_t pos = head_.load(std::memory_order_relaxed);
+            while(true){
+                Cell& cell = cells_[pos & mask_];
+                size_t seq = cell.seq.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if(diff == 0){
+                    if(head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)){
+                        T* item = cell.item;
+                        cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                        return item;
+                    }
+                }else if(diff < 0){
+                    return nullptr;
+                }else{
+                    pos = head_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+    private:
+        struct Cell{
+            std::atomic<size_t> seq;
+            T* item;
+        };
+        alignas(64) std::atomic<size_t> head_{0};//消费位置
+        alignas(64) std::atomic<size_t> tail_{0};//生产位置
+        alignas(64) const size_t mask_;
+        std::unique_ptr<Cell[]> cells_;
+};
+#endif
@@ -0,0 +1,186 @@
+/**
+ * @file http_request_test.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 请求解析在任意位置拆开、两次解析之间数据搬到新地址时结果和一次解析相同，包括格式错误的请求
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "test.hpp"
+#include "../buffer/buffer.hpp"
+#include "../http/http_request.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+namespace {
+const std::vector<std::string> VALID = {
+    "GET /index.html?a=1&b=2 HTTP/1.1\r\nHost: example.com\r\nUser-Agent:  curl/8 \r\nAccept: */*\r\n\r\n",
+    "POST /login HTTP/1.1\r\nHost: x\r\nContent-Length: 11\r\nContent-Type: text/plain\r\n\r\nhello world",
+    "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n",
+    "GET / HTTP/1.0\r\n\r\n",
+    "GET / HTTP/1.1\r\nConnection: foo, close\r\n\r\n",
+    "GET /x HTTP/1.1\r\nA:\r\nB:\t v \t\r\n\r\n",
+};
+const std::vector<std::string> MALFORMED = {
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / FOO\r\n\r\n",
+    "G(T / HTTP/1.1\r\n\r\n",
+    "GET / HTTP/1.1\r\n folded\r\n\r\n",
+    "GET / HTTP/1.1\r\nBad Name: x\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length: 2\r\nContent-Length: 3\r\n\r\nabc",
+    "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+    "POST / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n",
+    "GET / HTTP/1.1\r\nX: a\x01" "b\r\n\r\n",
+    "GET /\x7f HTTP/1.1\r\n\r\n",
+};
+/**
+ * @brief 把解析结果和所有字段拼成一个字符串，方便比较
+ *
+ */
+std::string Dump(const HttpRequest& request, HttpRequest::PARSE_RESULT result){
+    if(result == HttpRequest::PARSE_ERROR){
+        return "error " + std::to_string(request.ErrorCode());
+    }
+    if(result == HttpRequest::PARSE_AGAIN){
+        return "again";
+    }
+    std::string out;
+    out.append(request.Method()).append("|").append(request.Path()).append("|").append(request.Query());
+    out.append("|").append(request.Version()).append("|");
+    for(size_t i = 0; i < request.HeaderCount(); i++){
+        out.append(request.HeaderName(i)).append("=").append(request.HeaderValue(i)).append(";");
+    }
+    out.append("|").append(request.Body());
+    out += "|" + std::to_string(request.IsKeepAlive()) + "|" + std::to_string(request.Length());
+    return out;
+}
+std::string Whole(const std::string& input){
+    HttpRequest request;
+    return Dump(request, request.Parse(input.data(), input.size()));
+}
+/**
+ * @brief 每次调用都把已经到达的数据复制到新分配的内存里再解析，模拟读缓冲搬移或者扩容
+ *
+ * @param sizes 每次到达的字节数
+ */
+std::string Pieces(const std::string& input, const std::vector<size_t>& sizes){
+    HttpRequest request;
+    HttpRequest::PARSE_RESULT result = HttpRequest::PARSE_AGAIN;
+    std::vector<std::unique_ptr<char[]>> keep;//旧的内存不释放，保证每次地址都不同
+    size_t arrived = 0;
+    for(size_t size : sizes){
+        arrived += size;
+        keep.emplace_back(new char[arrived]);
+        input.copy(keep.back().get(), arrived);
+        result = request.Parse(keep.back().get(), arrived);
+        if(result != HttpRequest::PARSE_AGAIN){
+            break;
+        }
+    }
+    return Dump(request, result);
+}
+/**
+ * @brief 在每个位置拆成两次到达，再逐字节到达一次
+ *
+ */
+void TestSplits(const std::string& input, const std::string& expected){
+    for(size_t k = 1; k < input.size(); k++){
+        std::string got = Pieces(input, {k, input.size() - k});
+        if(got != expected){
+            fprintf(stderr, "split at %zu: '%s' != '%s'\n", k, got.c_str(), expected.c_str());
+            CHECK(got == expected);
+            return;
+        }
+    }
+    CHECK(Pieces(input, std::vector<size_t>(input.size(), 1)) == expected);
+}
+/**
+ * @brief 和连接一样在Buffer上解析，前面有已经取走的数据，后半部分到达时Buffer搬移或者扩容
+ *
+ */
+void TestBufferSplits(const std::string& input, const std::string& expected){
+    for(size_t k = 1; k < input.size(); k++){
+        Buffer buff(input.size());
+        buff.Append(std::string(input.size() - k, 'f'));
+        buff.Append(input.data(), k);
+        buff.Retrieve(input.size() - k);
+        HttpRequest request;
+        HttpRequest::PARSE_RESULT result = request.Parse(buff);
+        if(result == HttpRequest::PARSE_AGAIN){
+            buff.Append(input.data() + k, input.size() - k);
+            result = request.Parse(buff);
+        }
+        std::string got = Dump(request, result);
+        if(got != expected){
+            fprintf(stderr, "buffer split at %zu: '%s' != '%s'\n", k, got.c_str(), expected.c_str());
+            CHECK(got == expected);
+            return;
+        }
+    }
+}
+void TestFields(){
+    HttpRequest request;
+    const std::string& get = VALID[0];
+    CHECK(request.Parse(get.data(), get.size()) == HttpRequest::PARSE_OK);
+    CHECK(request.Method() == "GET");
+    CHECK(request.Path() == "/index.html");
+    CHECK(request.Query() == "a=1&b=2");
+    CHECK(request.GetHeader("user-agent") == "curl/8");
+    CHECK(request.IsKeepAlive());
+    CHECK(request.Length() == get.size());
+    request.Init();
+    const std::string& post = VALID[1];
+    CHECK(request.Parse(post.data(), post.size()) == HttpRequest::PARSE_OK);
+    CHECK(request.Body() == "hello world");
+    CHECK(request.ContentLength() == 11);
+    request.Init();
+    CHECK(request.Parse(VALID[3].data(), VALID[3].size()) == HttpRequest::PARSE_OK);
+    CHECK(!request.IsKeepAlive());//HTTP/1.0默认关闭
+}
+void TestPipelined(){
+    std::string pipe = VALID[0] + VALID[1] + VALID[2];
+    size_t off = 0;
+    int count = 0;
+    while(off < pipe.size()){
+        HttpRequest request;
+        if(request.Parse(pipe.data() + off, pipe.size() - off) != HttpRequest::PARSE_OK){
+            break;
+        }
+        off += request.Length();
+        count++;
+    }
+    CHECK(count == 3);
+    CHECK(off == pipe.size());
+}
+void TestLimits(){
+    std::string many = "GET / HTTP/1.1\r\n";
+    for(size_t i = 0; i <= HttpRequest::MAX_HEADERS; i++){
+        many += "H" + std::to_string(i) + ": v\r\n";
+    }
+    many += "\r\n";
+    CHECK(Whole(many).compare(0, 5, "error") == 0);
+    std::string longLine = "GET /" + std::string(HttpRequest::MAX_REQUEST_LINE, 'a');
+    CHECK(Whole(longLine).compare(0, 5, "error") == 0);
+}
+}
+int main(){
+    for(const std::string& input : VALID){
+        std::string expected = Whole(input);
+        CHECK(expected.compare(0, 5, "error") != 0 && expected != "again");
+        TestSplits(input, expected);
+        TestBufferSplits(input, expected);
+    }
+    for(const std::string& input : MALFORMED){
+        std::string expected = Whole(input);
+        CHECK(expected.compare(0, 5, "error") == 0);
+        TestSplits(input, expected);
+        TestBufferSplits(input, expected);
+    }
+    TestFields();
+    TestPipelined();
+    TestLimits();
+    return test::Result();
+}
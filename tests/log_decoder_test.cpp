@@ -0,0 +1,79 @@
+/**
+ * @file log_decoder_test.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 二进制日志解码后的参数和snprintf的结果一致，包括不同宽度的负数按%x、%o、%u输出
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "test.hpp"
+#include "../log/log.hpp"
+#include "../log/log_decoder.hpp"
+#include <cstdlib>
+#include <dirent.h>
+#include <string>
+#include <vector>
+namespace {
+std::vector<std::string> expected;
+template<typename... Args>
+void Expect(const char* format, Args... args){
+    char buff[256];
+    snprintf(buff, sizeof(buff), format, args...);
+    expected.push_back(buff);
+}
+}
+#define LOG_AND_EXPECT(format, ...) \
+    do{ \
+        LOG_STRUCT_INFO(format, __VA_ARGS__) \
+        Expect(format, __VA_ARGS__); \
+    }while(0)
+int main(){
+    char dir[] = "/tmp/webserver_log_decoder_test_XXXXXX";
+    if(!mkdtemp(dir)){
+        perror("mkdtemp");
+        return 1;
+    }
+    Log::Instance()->init(INFO, dir, ".log", 0, LOG_BINARY);//同步模式，写完就在文件里
+    LOG_AND_EXPECT("%x %o %u", -1, -8, -2);
+    LOG_AND_EXPECT("%X %d %i", static_cast<short>(-3), static_cast<signed char>(-4), -5);
+    LOG_AND_EXPECT("%hx %hhx %hu %hhd", -1, -1, 70000, 255);
+    LOG_AND_EXPECT("%lx %llo %lu %ld", -1l, -8ll, -2ul, -9l);
+    LOG_AND_EXPECT("%zu %zx %d", static_cast<size_t>(-1), static_cast<size_t>(1) << 40, 2147483647);
+    LOG_AND_EXPECT("%u %x %c", 4294967295u, static_cast<unsigned short>(65535), 'a');
+    LOG_AND_EXPECT("%08x|%-6d|%+d", -16, -7, 3);
+    DIR* d = opendir(dir);
+    std::string path;
+    while(dirent* entry = readdir(d)){
+        if(entry->d_name[0] != '.'){
+            path = std::string(dir) + "/" + entry->d_name;
+        }
+    }
+    closedir(d);
+    FILE* fp = fopen(path.c_str(), "rb");
+    CHECK(fp != nullptr);
+    if(!fp){
+        return test::Result();
+    }
+    LogDecoder decoder(fp);
+    CHECK(decoder.ReadHeader());
+    std::string line;
+    size_t i = 0;
+    LogDecoder::DECODE_STATE state;
+    while((state = decoder.Next(line)) == LogDecoder::DECODE_OK){
+        size_t pos = line.find("[info]:");
+        CHECK(pos != std::string::npos);
+        if(i < expected.size() && line.compare(pos + 7, std::string::npos, expected[i]) != 0){
+            fprintf(stderr, "decoded '%s', expected '%s'\n", line.c_str() + pos + 7, expected[i].c_str());
+            CHECK(false);
+        }
+        i++;
+    }
+    CHECK(state == LogDecoder::DECODE_END);
+    CHECK(i == expected.size());
+    fclose(fp);
+    remove(path.c_str());
+    remove(dir);
+    return test::Result();
+}
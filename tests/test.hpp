@@ -0,0 +1,36 @@
+/**
+ * @file test.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 测试用的断言，失败时打印位置并记录，main返回失败个数
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#pragma once
+#ifndef _TEST_HPP_
+#define _TEST_HPP_
+#include <cstdio>
+namespace test {
+inline int& Failures(){
+    static int failures = 0;
+    return failures;
+}
+inline int Result(){
+    if(Failures() == 0){
+        printf("all passed\n");
+    }else{
+        printf("%d check(s) failed\n", Failures());
+    }
+    return Failures() == 0 ? 0 : 1;
+}
+}
+#define CHECK(cond) \
+    do{ \
+        if(!(cond)){ \
+            test::Failures()++; \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    }while(0)
+#endif
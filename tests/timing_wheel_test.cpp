@@ -0,0 +1,113 @@
+/**
+ * @file timing_wheel_test.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 时间轮的超时测试，时间由tick(now_ms)推进，包括超出时间轮范围的超时
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "test.hpp"
+#include "../timer/timing_wheel.hpp"
+#include <climits>
+#include <cstdint>
+#include <map>
+namespace {
+constexpr int64_t WHEEL_TICKS = 1ll << 26;//第0层8位加上三层各6位
+/**
+ * @brief 记录每个id第一次超时时的相对时间
+ *
+ */
+struct Recorder{
+    std::map<int, int64_t> fired;
+    int64_t start = 0;
+    const TimingWheel* wheel = nullptr;
+    void operator()(int id){
+        fired.emplace(id, wheel->NowMs() - start);
+    }
+};
+void TestShortTimers(){
+    TimingWheel wheel(1);
+    Recorder rec;
+    rec.start = wheel.NowMs();
+    rec.wheel = &wheel;
+    wheel.SetExpireCallBack([&rec](int id){ rec(id); });
+    wheel.add(1, 0);
+    wheel.add(2, 255);
+    wheel.add(3, 256);
+    wheel.add(4, 70000);
+    wheel.add(5, 500);
+    wheel.cancel(5);
+    for(int64_t t = 0; t <= 70000; t++){
+        wheel.tick(rec.start + t);
+    }
+    CHECK(rec.fired.size() == 4);
+    CHECK(rec.fired[1] == 0);
+    CHECK(rec.fired[2] == 255);
+    CHECK(rec.fired[3] == 256);
+    CHECK(rec.fired[4] == 70000);
+    CHECK(rec.fired.count(5) == 0);
+    CHECK(wheel.size() == 0);
+}
+/**
+ * @brief 超时超过时间轮范围时不能提前触发，也不能推迟
+ *
+ * @param offset 添加定时器之前先推进的时间，让当前tick不对齐
+ * @param tick_ms
+ * @param timeout
+ */
+void TestLongTimer(int64_t offset, int tick_ms, int timeout){
+    TimingWheel wheel(tick_ms);
+    Recorder rec;
+    rec.start = wheel.NowMs();
+    rec.wheel = &wheel;
+    wheel.SetExpireCallBack([&rec](int id){ rec(id); });
+    wheel.tick(rec.start + offset);
+    wheel.add(1, timeout);
+    wheel.add(2, 1000);//同时存在的短定时器照常触发
+    const int64_t due = offset + (static_cast<int64_t>(timeout) + tick_ms - 1) / tick_ms * tick_ms;
+    CHECK(due - offset > WHEEL_TICKS * tick_ms);
+    //按一小时的步长推进到超时之前，再逐毫秒推进到超时
+    for(int64_t t = offset; t < due - tick_ms; t += 3600000){
+        wheel.tick(rec.start + t);
+    }
+    for(int64_t t = due - 2 * tick_ms; t < due; t++){
+        wheel.tick(rec.start + t);
+    }
+    CHECK(rec.fired.count(1) == 0);
+    CHECK(rec.fired.count(2) == 1);
+    CHECK(wheel.has(1));
+    wheel.tick(rec.start + due);
+    CHECK(rec.fired.count(1) == 1);
+    CHECK(rec.fired[1] == due);
+    CHECK(wheel.size() == 0);
+}
+/**
+ * @brief 超出范围的定时器可以调整成短的超时
+ *
+ */
+void TestAdjustLongTimer(){
+    TimingWheel wheel(1);
+    Recorder rec;
+    rec.start = wheel.NowMs();
+    rec.wheel = &wheel;
+    wheel.SetExpireCallBack([&rec](int id){ rec(id); });
+    wheel.add(7, INT_MAX);
+    wheel.tick(rec.start + 100);
+    wheel.adjust(7, 50);
+    for(int64_t t = 100; t <= 150; t++){
+        wheel.tick(rec.start + t);
+    }
+    CHECK(rec.fired[7] == 150);
+}
+}
+int main(){
+    TestShortTimers();
+    TestLongTimer(0, 1, 70000000);//约19.4小时，超过1ms一个tick时的范围
+    TestLongTimer(12345, 1, 70000000);
+    TestLongTimer(987654, 1, INT_MAX);
+    TestLongTimer(0, 10, INT_MAX);//10ms一个tick时范围约186小时，INT_MAX毫秒约596小时
+    TestAdjustLongTimer();
+    return test::Result();
+}
@@ -0,0 +1,42 @@
+/**
+ * @file coarse_clock.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 低开销的单调时钟
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef _COARSE_CLOCK_H_
+#define _COARSE_CLOCK_H_
+#include <chrono>
+#include <cstdint>
+#include <time.h>
+/**
+ * @brief 基于CLOCK_MONOTONIC_COARSE的时钟，满足std::chrono的Clock要求
+ * 读取的是内核在时钟中断时更新的值，走vDSO不进内核，精度是一个jiffy(1~4ms)，对连接超时足够
+ */
+struct CoarseClock{
+    typedef std::chrono::nanoseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<CoarseClock> time_point;
+    static constexpr bool is_steady = true;
+    static time_point now() noexcept{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return time_point(duration(static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec));
+    }
+    /**
+     * @brief 当前时间，单位毫秒
+     *
+     * @return int64_t
+     */
+    static int64_t NowMs() noexcept{
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        return static_cast<int64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+    }
+};
+#endif
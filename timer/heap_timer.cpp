@@ -5,101 +5,148 @@
 #include <utility>
 void HeapTimer::adjust(int id, int newExpires){
     assert(!heap_.empty()&&ref_.count(id));
-    heap_[ref_[id]].expires = Clock::now()+Ms(newExpires);
-    shift_down_(ref_[id],heap_.size());
+    timer& node = heap_[ref_[id]];
+    node.pending = now_+Ms(newExpires);
+    if(!node.adjusted){//同一轮里只登记一次，多次调整只保留最后一次
+        node.adjusted = true;
+        adjusted_.push_back(id);
+    }
 }
 void HeapTimer::add(int id,int time_out,const timeoutCallBack& call_bakc){
-    assert(id>0);
-    size_t i;
-    if(ref_.count(id)){
-        i = heap_.size();
+    assert(id>=0);
+    auto it = ref_.find(id);
+    if(it == ref_.end()){
+        size_t i = heap_.size();
         ref_[id] = i;
-        heap_.push_back(timer{id,Clock::now()+Ms(time_out),call_bakc});
+        heap_.push_back(timer{id,now_+Ms(time_out),call_bakc});
+        shift_up_(i);
     }
     else{
-        i = ref_[id];
-        heap_[i].expires = Clock::now()+Ms(time_out);
-        if(shift_down_(i, heap_.size())){
+        size_t i = it->second;
+        heap_[i].expires = now_+Ms(time_out);
+        heap_[i].call_back = call_bakc;
+        heap_[i].adjusted = false;
+        if(!shift_down_(i, heap_.size())){
             shift_up_(i);
         }
     }
 }
 void HeapTimer::doWork(int id){
-    if (heap_.empty()||!ref_.count(id)){
+    auto it = ref_.find(id);
+    if (it == ref_.end()){
         return;
     }
-    size_t i = ref_[id];
-    auto timer = heap_[i];
-    timer.call_back();
-    del_(id);
+    //先移出堆再调用，回调里可能重新添加同一个id
+    timeoutCallBack call_back = std::move(heap_[it->second].call_back);
+    del_(it->second);
+    if(call_back){
+        call_back();
+    }
+}
+void HeapTimer::cancel(int id){
+    auto it = ref_.find(id);
+    if(it != ref_.end()){
+        del_(it->second);
+    }
 }
 void HeapTimer::clear(){
     heap_.clear();
     ref_.clear();
+    adjusted_.clear();
 }
 void HeapTimer::pop(){
     assert(!heap_.empty());
     del_(0);
 }
 void HeapTimer::tick(){
+    Refresh();
+    apply_adjust_();
     if(heap_.empty()){
         return;
     }
-    while(!heap_.empty()){
-        auto timer = heap_.front();
-        if(std::chrono::duration_cast<Ms>(timer.expires-Clock::now()).count()>0){
-            break;
-        }
-        timer.call_back();
+    //先把所有超时的节点取出来，回调里增删定时器不会影响这一批
+    std::vector<timer> batch;
+    batch.swap(expired_);
+    while(!heap_.empty()&&heap_.front().expires<=now_){
+        batch.push_back(std::move(heap_.front()));
         pop();
     }
+    for(auto& node : batch){
+        if(node.call_back){
+            node.call_back();
+        }
+    }
+    batch.clear();
+    expired_.swap(batch);
 }
 int HeapTimer::GetNextTick(){
     tick();
-    size_t res = -1;
+    int res = -1;
     if(!heap_.empty()){
-        res = std::chrono::duration_cast<Ms>(heap_.front().expires-Clock::now()).count();
+        //向上取整，避免剩余不到1毫秒时epoll_wait(0)空转
+        res = static_cast<int>(std::chrono::ceil<Ms>(heap_.front().expires-now_).count());
         if(res < 0){
             res = 0;
         }
     }
     return res;
 }
-void HeapTimer::del_(size_t index){
-    assert(!heap_.empty()&&index>=0&&index<heap_.size());
-    size_t i = index;
-    size_t n = heap_.size() - i;
-    assert(i<=n);
-    if (i<n){
-        swap_node_(i, n);
-        if(!shift_down_(i, n)){
+void HeapTimer::apply_adjust_(){
+    for(int id : adjusted_){
+        auto it = ref_.find(id);
+        if(it == ref_.end()){//调整之后已经被删除
+            continue;
+        }
+        size_t i = it->second;
+        timer& node = heap_[i];
+        if(!node.adjusted){
+            continue;
+        }
+        node.adjusted = false;
+        node.expires = node.pending;
+        if(!shift_down_(i, heap_.size())){
             shift_up_(i);
         }
     }
+    adjusted_.clear();
+}
+void HeapTimer::del_(size_t index){
+    assert(!heap_.empty()&&index<heap_.size());
+    size_t n = heap_.size() - 1;
+    if (index<n){
+        swap_node_(index, n);
+    }
     ref_.erase(heap_.back().id);
     heap_.pop_back();
+    if(index<heap_.size()){
+        if(!shift_down_(index, heap_.size())){
+            shift_up_(index);
+        }
+    }
 }
 void HeapTimer::shift_up_(size_t i){
-    assert(i>0&&i<heap_.size());
-    size_t j  = (i-1)/2;
-    while(j>=0){
-        if(heap_[j]<heap_[i]){
+    assert(i<heap_.size());
+    while(i>0){
+        size_t j = (i-1)/2;
+        if(!(heap_[i]<heap_[j])){
             break;
         }
         swap_node_(i,j);
         i = j;
-        j = (i-1)/2;
     }
 }
 bool HeapTimer::shift_down_(size_t index,size_t n){
-    assert(index>0&&index<heap_.size());
-    assert(n>0&&n<heap_.size());
+    assert(index<heap_.size());
+    assert(n<=heap_.size());
     size_t i = index;
     size_t j = i*2+1;
     while (j<n) {
         if(j+1<n&&heap_[j+1]<heap_[j]){
             j++;
         }
+        if(!(heap_[j]<heap_[i])){
+            break;
+        }
         swap_node_(i, j);
         i = j;
         j = i * 2 +1;
@@ -107,10 +154,9 @@ bool HeapTimer::shift_down_(size_t index,size_t n){
     return i>index;
 }
 void HeapTimer::swap_node_(size_t i,size_t j){
-    assert(i>0&&i<heap_.size());
-    assert(j>0&&j<heap_.size());
+    assert(i<heap_.size());
+    assert(j<heap_.size());
     std::swap(heap_[i],heap_[j]);
     ref_[heap_[i].id] = i;
-    ref_[heap_[j].id] = j;   
-
-}
\ No newline at end of file
+    ref_[heap_[j].id] = j;
+}
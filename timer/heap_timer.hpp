@@ -10,45 +10,101 @@
  */
 #ifndef _HEAP_TIMER_H_
 #define _HEAP_TIMER_H_
+#include "coarse_clock.hpp"
 #include <cstddef>
 #include <functional>
 #include <chrono>
 #include <vector>
 #include <unordered_map>
 typedef std::function<void()> timeoutCallBack;
-typedef std::chrono::high_resolution_clock Clock;
-typedef std::chrono::microseconds Ms; 
+typedef CoarseClock Clock;
+typedef std::chrono::milliseconds Ms;
 typedef Clock::time_point TimeStamp;
 typedef struct TimerNode {
   int id;
   TimeStamp expires;
   timeoutCallBack call_back;
+  TimeStamp pending{};//延迟调整的新超时时间，下次整理堆时生效
+  bool adjusted = false;
   bool operator<(const TimerNode &other) const {
     return expires < other.expires;
   }
 } timer;
+/**
+ * @brief 小根堆定时器
+ * 每轮事件循环只读一次时钟：tick和Refresh更新缓存的当前时间，add和adjust都基于缓存计算超时时间。
+ * adjust只记录新的超时时间，同一轮里对同一个id的多次调整在下次tick时合并成一次堆调整
+ */
 class HeapTimer{
     public:
-        HeapTimer(){
+        HeapTimer():now_(Clock::now()){
             this->heap_.reserve(64);
         }
         ~HeapTimer(){
             this->clear();
         }
+        /**
+         * @brief 调整定时器的超时时间，延迟到下次tick时生效
+         *
+         * @param id
+         * @param newExpires 新的超时时间，单位毫秒
+         */
         void adjust(int id, int newExpires);
+        /**
+         * @brief 添加定时器，id已经存在时替换回调并重置超时时间
+         *
+         * @param id
+         * @param time_out 超时时间，单位毫秒
+         * @param call_bakc
+         */
         void add(int id,int time_out,const timeoutCallBack& call_bakc);
         void doWork(int id);
+        /**
+         * @brief 删除定时器，不调用回调
+         *
+         * @param id
+         */
+        void cancel(int id);
+        bool has(int id) const{
+            return ref_.count(id) != 0;
+        }
         void clear();
         void pop();
+        /**
+         * @brief 刷新缓存的当前时间，事件循环在epoll_wait返回后调用一次
+         *
+         */
+        void Refresh(){
+            now_ = Clock::now();
+        }
+        /**
+         * @brief 刷新时间，把所有超时的定时器先取出来再依次调用回调
+         *
+         */
         void tick();
+        /**
+         * @brief 处理超时的定时器并返回距离下一个超时的毫秒数
+         *
+         * @return int 没有定时器时返回-1
+         */
         int GetNextTick();
+        size_t size() const{
+            return heap_.size();
+        }
     private:
+        /**
+         * @brief 把延迟的调整应用到堆上
+         *
+         */
+        void apply_adjust_();
         void del_(size_t index);
         void shift_up_(size_t i);
         bool shift_down_(size_t index,size_t n);
         void swap_node_(size_t i,size_t j);
         std::vector<timer> heap_;
         std::unordered_map<int,size_t> ref_;
-              
+        std::vector<int> adjusted_;//本轮被调整过的id
+        std::vector<timer> expired_;//本轮超时的节点，复用内存
+        TimeStamp now_;//缓存的当前时间
 };
 #endif
\ No newline at end of file
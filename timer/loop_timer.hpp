@@ -0,0 +1,185 @@
+/**
+ * @file loop_timer.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 事件循环线程独占的定时器
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef _LOOP_TIMER_H_
+#define _LOOP_TIMER_H_
+#include "heap_timer.hpp"
+#include "mpsc_queue.hpp"
+#include <assert.h>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <utility>
+/**
+ * @brief 每个事件循环一个的定时器
+ * 定时器只由所属的事件循环线程操作，不加锁；其他线程的add/adjust/cancel写进无锁MPSC队列，
+ * 所属线程在每次tick开始时统一执行。堆或时间轮的数据只在所属线程的缓存里
+ * @tparam Timer HeapTimer或TimingWheel
+ */
+template<typename Timer = HeapTimer>
+class LoopTimer{
+    public:
+        typedef std::function<void()> CallBack;
+        LoopTimer():owner_(std::this_thread::get_id()){}
+        LoopTimer(const LoopTimer&) = delete;
+        LoopTimer& operator=(const LoopTimer&) = delete;
+        /**
+         * @brief 把当前线程设为所属线程，事件循环线程启动后调用
+         *
+         */
+        void BindThread(){
+            owner_ = std::this_thread::get_id();
+        }
+        bool InLoopThread() const{
+            return owner_ == std::this_thread::get_id();
+        }
+        /**
+         * @brief 设置唤醒事件循环的回调，比如写eventfd
+         * 其他线程提交命令且队列里原来没有未处理的命令时调用，让阻塞在epoll_wait的循环尽快处理
+         *
+         * @param wake_up
+         */
+        void SetWakeUp(const CallBack& wake_up){
+            wake_up_ = wake_up;
+        }
+        /**
+         * @brief 添加或者重置定时器，可以在任意线程调用
+         *
+         * @param id
+         * @param time_out 超时时间，单位毫秒
+         * @param call_back 在所属线程上调用
+         */
+        void add(int id, int time_out, const CallBack& call_back){
+            if(InLoopThread()){
+                timer_.add(id, time_out, call_back);
+            }else{
+                Post_(Command{ADD, id, time_out, call_back});
+            }
+        }
+        /**
+         * @brief 调整超时时间，可以在任意线程调用，其他线程调整时定时器已经不存在就忽略
+         *
+         * @param id
+         * @param time_out 超时时间，单位毫秒
+         */
+        void adjust(int id, int time_out){
+            if(InLoopThread()){
+                timer_.adjust(id, time_out);
+            }else{
+                Post_(Command{ADJUST, id, time_out, nullptr});
+            }
+        }
+        /**
+         * @brief 删除定时器，不调用回调，可以在任意线程调用
+         *
+         * @param id
+         */
+        void cancel(int id){
+            if(InLoopThread()){
+                timer_.cancel(id);
+            }else{
+                Post_(Command{CANCEL, id, 0, nullptr});
+            }
+        }
+        /**
+         * @brief 立即调用回调并删除，只能在所属线程调用
+         *
+         * @param id
+         */
+        void doWork(int id){
+            assert(InLoopThread());
+            timer_.doWork(id);
+        }
+        /**
+         * @brief 刷新缓存的当前时间，只能在所属线程调用
+         *
+         */
+        void Refresh(){
+            assert(InLoopThread());
+            timer_.Refresh();
+        }
+        /**
+         * @brief 执行其他线程提交的命令，再处理超时的定时器
+         *
+         */
+        void tick(){
+            assert(InLoopThread());
+            Drain_();
+            timer_.tick();
+        }
+        /**
+         * @brief 执行其他线程提交的命令，处理超时的定时器并返回距离下一个超时的毫秒数
+         *
+         * @return int 没有定时器时返回-1
+         */
+        int GetNextTick(){
+            assert(InLoopThread());
+            Drain_();
+            return timer_.GetNextTick();
+        }
+        size_t size() const{
+            return timer_.size();
+        }
+        /**
+         * @brief 底层定时器，只能在所属线程使用
+         *
+         * @return Timer&
+         */
+        Timer& timer(){
+            return timer_;
+        }
+    private:
+        enum COMMAND_TYPE{
+            ADD,
+            ADJUST,
+            CANCEL
+        };
+        struct Command{
+            COMMAND_TYPE type = CANCEL;
+            int id = -1;
+            int time_out = 0;
+            CallBack call_back;
+        };
+        void Post_(Command&& command){
+            commands_.Push(std::move(command));
+            //入队之后再设置标记，消费者清除标记之后入队的命令一定会再唤醒一次
+            if(!pending_.exchange(true, std::memory_order_acq_rel) && wake_up_){
+                wake_up_();
+            }
+        }
+        void Drain_(){
+            if(!pending_.load(std::memory_order_acquire)){
+                return;
+            }
+            pending_.store(false, std::memory_order_seq_cst);
+            Command command;
+            while(commands_.Pop(command)){
+                switch(command.type){
+                    case ADD:
+                        timer_.add(command.id, command.time_out, command.call_back);
+                        break;
+                    case ADJUST:
+                        if(timer_.has(command.id)){
+                            timer_.adjust(command.id, command.time_out);
+                        }
+                        break;
+                    case CANCEL:
+                        timer_.cancel(command.id);
+                        break;
+                }
+            }
+        }
+        Timer timer_;
+        std::thread::id owner_;
+        CallBack wake_up_;
+        MpscQueue<Command> commands_;
+        alignas(64) std::atomic<bool> pending_{false};//有未处理的命令
+};
+#endif
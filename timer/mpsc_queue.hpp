@@ -0,0 +1,73 @@
+/**
+ * @file mpsc_queue.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 多生产者单消费者无锁队列
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef _MPSC_QUEUE_H_
+#define _MPSC_QUEUE_H_
+#include <atomic>
+#include <utility>
+/**
+ * @brief Vyukov无界MPSC队列
+ * 生产者一次exchange加一次store完成入队，不会阻塞也不会失败；只有一个消费者可以Pop。
+ * 生产者exchange之后、链接之前被打断时，消费者暂时看不到它和它之后的元素，下次Pop就能看到
+ * @tparam T 需要可以默认构造
+ */
+template<typename T>
+class MpscQueue{
+    public:
+        MpscQueue(){
+            Node* stub = new Node();
+            head_.store(stub, std::memory_order_relaxed);
+            tail_ = stub;
+        }
+        ~MpscQueue(){
+            T value;
+            while(Pop(value)){
+            }
+            delete tail_;
+        }
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+        /**
+         * @brief 任意线程入队
+         *
+         * @param value
+         */
+        void Push(T value){
+            Node* node = new Node();
+            node->value = std::move(value);
+            Node* prev = head_.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+        }
+        /**
+         * @brief 消费者出队
+         *
+         * @param value
+         * @return true
+         * @return false 队列为空
+         */
+        bool Pop(T& value){
+            Node* next = tail_->next.load(std::memory_order_acquire);
+            if(!next){
+                return false;
+            }
+            value = std::move(next->value);//next成为新的哨兵
+            delete tail_;
+            tail_ = next;
+            return true;
+        }
+    private:
+        struct Node{
+            std::atomic<Node*> next{nullptr};
+            T value;
+        };
+        alignas(64) std::atomic<Node*> head_;//生产者端，最后入队的节点
+        alignas(64) Node* tail_;//消费者端，哨兵节点
+};
+#endif
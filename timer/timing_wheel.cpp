@@ -0,0 +1,220 @@
+#include "timing_wheel.hpp"
+#include "coarse_clock.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <utility>
+TimingWheel::TimingWheel(int tick_ms)
+    :heads_(ROOT_SIZE + LEVELS * LEVEL_SIZE, NIL),current_(0),start_ms_(CoarseClock::NowMs()),now_ms_(start_ms_),tick_ms_(tick_ms),count_(0){
+    assert(tick_ms > 0);
+    memset(root_bitmap_, 0, sizeof(root_bitmap_));
+}
+void TimingWheel::add(int id, int time_out){
+    assert(id >= 0);
+    if(static_cast<size_t>(id) >= nodes_.size()){
+        nodes_.resize(id + 1);
+    }
+    Node& node = nodes_[id];
+    if(node.slot != NIL){//已经存在就重置
+        Unlink_(id);
+        count_--;
+    }
+    if(node.has_call_back){
+        call_backs_[id] = nullptr;
+        node.has_call_back = false;
+    }
+    Schedule_(id, NowTick_() + TicksOf_(time_out));
+    count_++;
+}
+void TimingWheel::add(int id, int time_out, const std::function<void()>& call_back){
+    add(id, time_out);
+    if(static_cast<size_t>(id) >= call_backs_.size()){
+        call_backs_.resize(id + 1);
+    }
+    call_backs_[id] = call_back;
+    nodes_[id].has_call_back = true;
+}
+void TimingWheel::adjust(int id, int newExpires){
+    assert(id >= 0 && static_cast<size_t>(id) < nodes_.size() && nodes_[id].slot != NIL);
+    Unlink_(id);
+    Schedule_(id, NowTick_() + TicksOf_(newExpires));
+}
+void TimingWheel::cancel(int id){
+    if(id < 0 || static_cast<size_t>(id) >= nodes_.size() || nodes_[id].slot == NIL){
+        return;
+    }
+    Unlink_(id);
+    count_--;
+    if(nodes_[id].has_call_back){
+        call_backs_[id] = nullptr;
+        nodes_[id].has_call_back = false;
+    }
+}
+void TimingWheel::doWork(int id){
+    if(id < 0 || static_cast<size_t>(id) >= nodes_.size() || nodes_[id].slot == NIL){
+        return;
+    }
+    Unlink_(id);
+    count_--;
+    Expire_(id);
+}
+void TimingWheel::clear(){
+    std::fill(heads_.begin(), heads_.end(), NIL);
+    nodes_.clear();
+    call_backs_.clear();
+    memset(root_bitmap_, 0, sizeof(root_bitmap_));
+    count_ = 0;
+}
+void TimingWheel::Refresh(){
+    now_ms_ = CoarseClock::NowMs();
+}
+void TimingWheel::tick(){
+    Refresh();
+    Advance_();
+}
+void TimingWheel::tick(int64_t now_ms){
+    now_ms_ = now_ms;
+    Advance_();
+}
+void TimingWheel::Advance_(){
+    const uint64_t now = NowTick_();
+    while(current_ <= now){
+        if(count_ == 0){//没有定时器直接追上当前时间
+            current_ = now + 1;
+            break;
+        }
+        const int index = current_ & (ROOT_SIZE - 1);
+        if(index == 0){//第0层转完一圈，逐层把上面的节点搬下来
+            for(int level = 1; level <= LEVELS; level++){
+                int shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+                if(Cascade_(level, (current_ >> shift) & (LEVEL_SIZE - 1)) != 0){
+                    break;
+                }
+            }
+        }
+        current_++;
+        const int slot = SlotOf_(0, index);
+        while(heads_[slot] != NIL){//回调里可能增删定时器，每次都从链表头取
+            int id = heads_[slot];
+            Unlink_(id);
+            count_--;
+            Expire_(id);
+        }
+        if(current_ <= now){//跳过中间没有事件的tick
+            current_ = std::min(NextEventTick_(), now + 1);
+        }
+    }
+}
+int TimingWheel::GetNextTick(){
+    tick();
+    if(count_ == 0){
+        return -1;
+    }
+    int64_t elapsed = now_ms_ - start_ms_;
+    int64_t res = static_cast<int64_t>(NextEventTick_()) * tick_ms_ - elapsed;
+    return res > 0 ? static_cast<int>(res) : 0;
+}
+uint64_t TimingWheel::NowTick_() const{
+    return (now_ms_ - start_ms_) / tick_ms_;
+}
+uint64_t TimingWheel::TicksOf_(int ms) const{
+    return (static_cast<uint64_t>(std::max(ms, 0)) + tick_ms_ - 1) / tick_ms_;//向上取整，在64位上计算避免溢出
+}
+void TimingWheel::Schedule_(int id, uint64_t expires){
+    Node& node = nodes_[id];
+    int slot;
+    if(expires < current_){//已经超时的放到下一个要处理的槽
+        expires = current_;
+        slot = SlotOf_(0, current_ & (ROOT_SIZE - 1));
+    }else{
+        uint64_t idx = expires - current_;
+        uint64_t at = expires;//用来选择槽的tick
+        if(idx > MAX_TICKS){//超过时间轮范围的先放在最远的槽，节点保留原来的超时，搬移时再重新计算
+            at = current_ + MAX_TICKS;
+            idx = MAX_TICKS;
+        }
+        if(idx < static_cast<uint64_t>(ROOT_SIZE)){
+            slot = SlotOf_(0, at & (ROOT_SIZE - 1));
+        }else{
+            int level = 1;
+            while(level < LEVELS && idx >= (1ull << (ROOT_BITS + level * LEVEL_BITS))){
+                level++;
+            }
+            int shift = ROOT_BITS + (level - 1) * LEVEL_BITS;
+            slot = SlotOf_(level, (at >> shift) & (LEVEL_SIZE - 1));
+        }
+    }
+    node.expires = expires;
+    Link_(id, slot);
+}
+void TimingWheel::Link_(int id, int slot){
+    Node& node = nodes_[id];
+    node.slot = slot;
+    node.prev = NIL;
+    node.next = heads_[slot];
+    if(node.next != NIL){
+        nodes_[node.next].prev = id;
+    }
+    heads_[slot] = id;
+    if(slot < ROOT_SIZE){
+        root_bitmap_[slot / 64] |= 1ull << (slot % 64);
+    }
+}
+void TimingWheel::Unlink_(int id){
+    Node& node = nodes_[id];
+    assert(node.slot != NIL);
+    if(node.prev != NIL){
+        nodes_[node.prev].next = node.next;
+    }else{
+        heads_[node.slot] = node.next;
+    }
+    if(node.next != NIL){
+        nodes_[node.next].prev = node.prev;
+    }
+    if(node.slot < ROOT_SIZE && heads_[node.slot] == NIL){
+        root_bitmap_[node.slot / 64] &= ~(1ull << (node.slot % 64));
+    }
+    node.slot = NIL;
+    node.prev = NIL;
+    node.next = NIL;
+}
+int TimingWheel::Cascade_(int level, int index){
+    const int slot = SlotOf_(level, index);
+    int id = heads_[slot];
+    heads_[slot] = NIL;
+    while(id != NIL){
+        int next = nodes_[id].next;
+        nodes_[id].slot = NIL;
+        Schedule_(id, nodes_[id].expires);
+        id = next;
+    }
+    return index;
+}
+uint64_t TimingWheel::NextEventTick_() const{
+    const int index = current_ & (ROOT_SIZE - 1);
+    if(index == 0){//下一个tick就要搬移
+        return current_;
+    }
+    //只在本圈剩下的槽里找，之前的槽属于下一圈，要等到下一次搬移
+    for(int w = index / 64; w < ROOT_SIZE / 64; w++){
+        uint64_t bits = root_bitmap_[w];
+        if(w == index / 64){
+            bits &= ~0ull << (index % 64);
+        }
+        if(bits){
+            return current_ - index + w * 64 + __builtin_ctzll(bits);
+        }
+    }
+    return (current_ | (ROOT_SIZE - 1)) + 1;
+}
+void TimingWheel::Expire_(int id){
+    Node& node = nodes_[id];
+    if(node.has_call_back){//先移出来，回调里可能重新添加同一个id
+        std::function<void()> call_back = std::move(call_backs_[id]);
+        call_backs_[id] = nullptr;
+        node.has_call_back = false;
+        call_back();
+    }else if(expire_call_back_){
+        expire_call_back_(id);
+    }
+}
@@ -0,0 +1,186 @@
+/**
+ * @file timing_wheel.hpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 分层时间轮
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#ifndef _TIMING_WHEEL_H_
+#define _TIMING_WHEEL_H_
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+/**
+ * @brief 分层时间轮
+ * 第0层256个槽，每个槽一个tick；往上三层各64个槽，每层的槽跨度是下一层一圈的长度。
+ * 节点按id(文件描述符)放在平坦数组里，用下标组成侵入式双向链表，添加、调整和删除都是O(1)
+ */
+class TimingWheel{
+    public:
+        typedef std::function<void(int id)> ExpireCallBack;
+        /**
+         * @brief 创建时间轮
+         *
+         * @param tick_ms 每个tick的毫秒数
+         */
+        explicit TimingWheel(int tick_ms = 1);
+        ~TimingWheel() = default;
+        /**
+         * @brief 设置没有单独回调的节点超时时调用的回调
+         *
+         * @param call_back
+         */
+        void SetExpireCallBack(const ExpireCallBack& call_back){
+            expire_call_back_ = call_back;
+        }
+        /**
+         * @brief 添加或者重置定时器，超时调用默认回调
+         *
+         * @param id
+         * @param time_out 超时时间，单位毫秒
+         */
+        void add(int id, int time_out);
+        /**
+         * @brief 添加或者重置定时器，超时调用call_back
+         *
+         * @param id
+         * @param time_out 超时时间，单位毫秒
+         * @param call_back
+         */
+        void add(int id, int time_out, const std::function<void()>& call_back);
+        /**
+         * @brief 调整定时器的超时时间
+         *
+         * @param id
+         * @param newExpires 新的超时时间，单位毫秒
+         */
+        void adjust(int id, int newExpires);
+        /**
+         * @brief 删除定时器，不调用回调
+         *
+         * @param id
+         */
+        void cancel(int id);
+        bool has(int id) const{
+            return id >= 0 && static_cast<size_t>(id) < nodes_.size() && nodes_[id].slot != NIL;
+        }
+        /**
+         * @brief 立即调用定时器的回调并删除
+         *
+         * @param id
+         */
+        void doWork(int id);
+        void clear();
+        /**
+         * @brief 刷新缓存的当前时间，事件循环在epoll_wait返回后调用一次，add和adjust都基于这个时间
+         *
+         */
+        void Refresh();
+        /**
+         * @brief 刷新时间并处理所有已经超时的定时器
+         *
+         */
+        void tick();
+        /**
+         * @brief 以调用者给出的时间处理超时的定时器，之后的add和adjust也基于这个时间
+         *
+         * @param now_ms 和NowMs()同一个时钟的毫秒数，不能比上次的时间早
+         */
+        void tick(int64_t now_ms);
+        /**
+         * @brief 缓存的当前时间，单位毫秒
+         *
+         * @return int64_t
+         */
+        int64_t NowMs() const{
+            return now_ms_;
+        }
+        /**
+         * @brief 处理超时的定时器并返回距离下一次需要处理的毫秒数，可以直接作为epoll_wait的超时
+         *
+         * @return int 没有定时器时返回-1
+         */
+        int GetNextTick();
+        size_t size() const{
+            return count_;
+        }
+    private:
+        static constexpr int ROOT_BITS = 8;
+        static constexpr int LEVEL_BITS = 6;
+        static constexpr int ROOT_SIZE = 1 << ROOT_BITS;
+        static constexpr int LEVEL_SIZE = 1 << LEVEL_BITS;
+        static constexpr int LEVELS = 3;//第0层之上的层数
+        static constexpr uint64_t MAX_TICKS = (1ull << (ROOT_BITS + LEVELS * LEVEL_BITS)) - 1;
+        static constexpr int NIL = -1;
+        /**
+         * @brief 定时器节点
+         *
+         */
+        struct Node{
+            int prev = NIL;
+            int next = NIL;
+            int slot = NIL;//所在的槽，NIL表示没有在时间轮里
+            bool has_call_back = false;
+            uint64_t expires = 0;//超时的tick，超出时间轮范围时也是原始值
+        };
+        /**
+         * @brief 缓存的当前时间对应的tick
+         *
+         * @return uint64_t
+         */
+        uint64_t NowTick_() const;
+        /**
+         * @brief 毫秒数换算成tick数
+         *
+         * @param ms
+         * @return uint64_t
+         */
+        uint64_t TicksOf_(int ms) const;
+        /**
+         * @brief 处理到缓存的当前时间为止所有超时的定时器
+         *
+         */
+        void Advance_();
+        /**
+         * @brief 按超时的tick把节点放进对应的槽
+         *
+         * @param id
+         * @param expires 超出时间轮范围时先放在最远的槽，节点仍然记录这个超时
+         */
+        void Schedule_(int id, uint64_t expires);
+        void Link_(int id, int slot);
+        void Unlink_(int id);
+        /**
+         * @brief 把某一层当前槽的节点重新放到下面的层
+         *
+         * @param level 1到LEVELS
+         * @param index
+         * @return int 槽的下标，为0时还要继续处理更上一层
+         */
+        int Cascade_(int level, int index);
+        /**
+         * @brief 下一个可能有事件的tick，可能是某个第0层的槽，也可能是下一次层间搬移
+         *
+         * @return uint64_t
+         */
+        uint64_t NextEventTick_() const;
+        void Expire_(int id);
+        int SlotOf_(int level, int index) const{
+            return level == 0 ? index : ROOT_SIZE + (level - 1) * LEVEL_SIZE + index;
+        }
+        std::vector<Node> nodes_;//按id索引的节点
+        std::vector<std::function<void()>> call_backs_;//单独设置的回调，只有用到时才分配
+        std::vector<int> heads_;//每个槽的链表头
+        uint64_t root_bitmap_[ROOT_SIZE / 64];//第0层非空槽的位图
+        uint64_t current_;//下一个要处理的tick
+        int64_t start_ms_;//时间轮创建的时间
+        int64_t now_ms_;//缓存的当前时间
+        int tick_ms_;
+        size_t count_;//定时器个数
+        ExpireCallBack expire_call_back_;
+};
+#endif
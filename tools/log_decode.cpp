@@ -0,0 +1,47 @@
+/**
+ * @file log_decode.cpp
+ * @author {gangx} ({gangx6906@gmail.com})
+ * @brief 把二进制日志文件转换成文本，用法: log_decode 文件...
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2024
+ *
+ */
+#include "log/log_decoder.hpp"
+#include <cstdio>
+#include <string>
+int main(int argc, char** argv){
+    if(argc < 2){
+        fprintf(stderr, "usage: %s file...\n", argv[0]);
+        return 1;
+    }
+    int ret = 0;
+    std::string line;
+    for(int i = 1; i < argc; i++){
+        FILE* fp = fopen(argv[i], "rb");
+        if(!fp){
+            perror(argv[i]);
+            ret = 1;
+            continue;
+        }
+        LogDecoder decoder(fp);
+        if(!decoder.ReadHeader()){
+            fprintf(stderr, "%s: not a binary log file\n", argv[i]);
+            fclose(fp);
+            ret = 1;
+            continue;
+        }
+        LogDecoder::DECODE_STATE state;
+        while((state = decoder.Next(line)) == LogDecoder::DECODE_OK){
+            line.push_back('\n');
+            fwrite(line.data(), 1, line.size(), stdout);
+        }
+        if(state == LogDecoder::DECODE_ERROR){
+            fprintf(stderr, "%s: truncated or corrupted record\n", argv[i]);
+            ret = 1;
+        }
+        fclose(fp);
+    }
+    return ret;
+}
@@ -1,7 +1,15 @@
 add_rules("mode.debug", "mode.release")
+set_languages("c++17")
 add_includedirs("./")
 add_linkdirs("./lib")
 
+-- 有zlib时压缩切换下来的日志文件
+option("zlib")
+    add_links("z")
+    add_cincludes("zlib.h")
+    add_defines("LOG_USE_ZLIB")
+option_end()
+
 target("webApp")
 
     target("buffer")
@@ -12,6 +20,7 @@ target("webApp")
     target("log")
         set_kind("static")
         add_files("log/*.cpp")
+        add_options("zlib")
         set_targetdir("lib")
     target_end()
     target("pool")
@@ -21,7 +30,7 @@ target("webApp")
     target_end()
     target("timer")
         set_kind("static")
-        add_files("pool/*.cpp")
+        add_files("timer/*.cpp")
         set_targetdir("lib")
     target_end()
     target("http")
@@ -32,9 +41,42 @@ target("webApp")
     set_kind("binary")
     add_files("main/*.cpp") 
     set_targetdir("bin")
-    add_links("buffer","pool","log","http","timer")
+    add_links("http","pool","timer","log","buffer","mysqlclient")--静态库按依赖顺序，使用者在前
+    add_syslinks("pthread")
+    add_options("zlib")
+target_end()
+
+target("log_decode")
+    set_kind("binary")
+    add_files("tools/log_decode.cpp", "log/log_decoder.cpp")
+    set_targetdir("bin")
 target_end()
 
+-- 基准测试，xmake build bench && xmake run bench [名称...]
+target("bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("bench/*.cpp", "main/reactor.cpp", "main/epoller.cpp")--事件循环不在静态库里，直接编译
+    set_targetdir("bin")
+    add_deps("http","pool","timer","log","buffer")
+    add_syslinks("pthread")
+    add_options("zlib")
+target_end()
+
+-- 测试，每个tests/*_test.cpp是一个程序，xmake test运行全部
+for _, file in ipairs(os.files("tests/*_test.cpp")) do
+    target(path.basename(file))
+        set_kind("binary")
+        set_default(false)
+        add_files(file)
+        set_targetdir("bin/tests")
+        add_deps("http","pool","timer","log","buffer")
+        add_syslinks("pthread")
+        add_options("zlib")
+        add_tests("default")
+    target_end()
+end
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --